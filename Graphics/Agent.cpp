@@ -7,6 +7,10 @@
 #include "Idle.h"
 #include "Globals.h"
 #include "Warrior.h"
+#include "TeamRoster.h"
+#include "SpatialIndex.h"
+#include "EventScheduler.h"
+#include "AllocCounter.h"
 #include <algorithm> // for clampValue
 
 // ============================================================
@@ -23,9 +27,27 @@ inline T clampValue(T v, T lo, T hi)
 // ============================================================
 // Constructor / Destructor
 // ============================================================
-Agent::Agent(TeamColor t, int r, int c) : team(t) { pos = { r, c }; }
+size_t Agent::transitions = 0;
+size_t Agent::switchAllocations = 0;
+size_t Agent::hookAllocations = 0;
+
+Agent::Agent(TeamColor t, AgentRole rl, int r, int c) : team(t), role(rl) { pos = { r, c }; }
 Agent::~Agent() {}
 
+// ============================================================
+// Life state (keeps the team roster's alive counts in sync)
+// ============================================================
+void Agent::setAlive(bool v)
+{
+    if (alive == v) return;
+    alive = v;
+
+    if (roster) {
+        if (alive) roster->onRevive(this);
+        else       roster->onDeath(this);
+    }
+}
+
 // ============================================================
 // Update
 // ============================================================
@@ -127,7 +149,7 @@ void Agent::render() const
     glEnd();
 
     // --- Ammo + Grenade bars (Warrior only) ---
-    if (dynamic_cast<const Warrior*>(this))
+    if (role == ROLE_WARRIOR)
     {
         // Ammo bar (red)
         double ammoRatio = clampValue(double(bullets) / double(maxBullets), 0.0, 1.0);
@@ -151,7 +173,7 @@ void Agent::render() const
         glEnd();
 
         // Grenade indicators (3 segments)
-        int grenades = dynamic_cast<const Warrior*>(this)->getGrenades();
+        int grenades = static_cast<const Warrior*>(this)->getGrenades();
         double grenadeY = ammoY - barHeight - 0.1;
         double segment = barWidth / 3.0;
 
@@ -188,9 +210,8 @@ void Agent::stepTowardTarget(const Map& world)
     // Try row step
     int nr = pos.r + dr, nc = pos.c;
     if (dr != 0 && world.inBounds(nr, nc)) {
-        auto ct = world.at(nr, nc);
-        if (ct != ROCK && ct != WATER) {
-            pos.r = nr;
+        if (!world.blocksMovement(nr, nc)) {
+            setPos({ nr, nc });
             moving = true;
             return;
         }
@@ -200,9 +221,8 @@ void Agent::stepTowardTarget(const Map& world)
     nr = pos.r;
     nc = pos.c + dc;
     if (dc != 0 && world.inBounds(nr, nc)) {
-        auto ct = world.at(nr, nc);
-        if (ct != ROCK && ct != WATER) {
-            pos.c = nc;
+        if (!world.blocksMovement(nr, nc)) {
+            setPos({ nr, nc });
             moving = true;
             return;
         }
@@ -211,18 +231,58 @@ void Agent::stepTowardTarget(const Map& world)
     moving = false;
 }
 
+// Moves the agent and keeps the spatial index in sync
+void Agent::setPos(const Vec2i& p)
+{
+    Vec2i old = pos;
+    pos = p;
+    if (gSpatialIndex)
+        gSpatialIndex->move(this, old, pos);
+}
+
+// ============================================================
+// Match Clock
+// ============================================================
+int Agent::now()
+{
+    return gTimingWheel ? gTimingWheel->now() : 0;
+}
+
+void Agent::armTimer(int& deadline, TimerKind kind, int delay)
+{
+    deadline = now() + delay;
+    if (gTimingWheel)
+        gTimingWheel->schedule(this, kind, deadline);
+}
+
 // ============================================================
 // FSM State Management
 // ============================================================
+// The hooks do the states' work (OnEnter plans a path) and are
+// counted apart; the switch between shared states must not touch
+// the heap, which the headless summary checks.
 void Agent::setState(State* s)
 {
-    if (current)
+    const AllocCounter::Snapshot start = AllocCounter::now();
+    size_t inHooks = 0;
+
+    if (current) {
+        const AllocCounter::Snapshot hook = AllocCounter::now();
         current->OnExit(this);
+        inHooks += AllocCounter::since(hook).allocations;
+    }
 
     current = s;
+    ++transitions;
 
-    if (current)
+    if (current) {
+        const AllocCounter::Snapshot hook = AllocCounter::now();
         current->OnEnter(this);
+        inHooks += AllocCounter::since(hook).allocations;
+    }
+
+    hookAllocations += inHooks;
+    switchAllocations += AllocCounter::since(start).allocations - inHooks;
 }
 
 // ============================================================
@@ -236,22 +296,20 @@ bool Agent::advanceAlongPath(const Map& world)
     }
 
     Vec2i next = path[pathIndex];
-    CellType ct = world.at(next.r, next.c);
 
-    if (ct == ROCK || ct == WATER) {
+    if (world.blocksMovement(next.r, next.c)) {
         moving = false;
         return false;
     }
 
     // Delay for animation
-    if (moveDelayCounter > 0) {
-        moveDelayCounter--;
+    if (now() < nextStepFrame)
         return true;
-    }
 
-    moveDelayCounter = MOVE_DELAY;
-    pos = next;
+    armTimer(nextStepFrame, TIMER_STEP, MOVE_DELAY + 1);
+    setPos(next);
     pathIndex++;
+    if (windowSteps > 0) --windowSteps;
 
     if (pathIndex >= (int)path.size()) {
         moving = false;
@@ -266,34 +324,28 @@ bool Agent::advanceAlongPath(const Map& world)
 // ============================================================
 void Agent::computeVisibility(const Map& world)
 {
-    if (vis.size() != size_t(MSZ * MSZ))
-        vis.assign(MSZ * MSZ, 0);
+    if (!vis.sameShape(world.rows(), world.cols())) {
+        vis.resize(world.rows(), world.cols(), 0);
+        visMin = { 0, 0 };
+        visMax = { -1, -1 };
+    }
 
-    std::fill(vis.begin(), vis.end(), 0);
+    // Only the sight window can hold set cells: clear last frame's
+    if (visMax.r >= 0)
+        vis.fillRect(visMin.r, visMin.c, visMax.r, visMax.c, 0);
 
     const int R = getSightRange();
-    const int r0 = pos.r;
-    const int c0 = pos.c;
-
-    vis[r0 * MSZ + c0] = 1;
+    visMin = world.clampCell(pos.r - R, pos.c - R);
+    visMax = world.clampCell(pos.r + R, pos.c + R);
 
-    int rMin = std::max(0, r0 - R);
-    int rMax = std::min(MSZ - 1, r0 + R);
-    int cMin = std::max(0, c0 - R);
-    int cMax = std::min(MSZ - 1, c0 + R);
-
-    for (int r = rMin; r <= rMax; ++r)
-    {
-        for (int c = cMin; c <= cMax; ++c)
-        {
-            int dr = r - r0;
-            int dc = c - c0;
-            if (dr * dr + dc * dc > R * R) continue;
+    // Disc of radius R, cells in line of sight only
+    world.kernels().sight(world.terrainBits(), pos, R, vis.data());
+}
 
-            if (world.hasLineOfSight({ r0, c0 }, { r, c }))
-                vis[r * MSZ + c] = 1;
-        }
-    }
+void Agent::mergeVisibilityInto(const Map& world, Grid<uint8_t>& out) const
+{
+    if (!vis.sameShape(out.rows(), out.cols())) return;
+    world.kernels().mergeVisibility(vis.data(), out.data(), out.rows(), out.cols(), visMin, visMax);
 }
 
 // ============================================================
@@ -306,9 +358,30 @@ void Agent::receiveOrder(const Order& o)
         o.type == OrderType::DEFEND)
     {
         setTarget(o.targetRow, o.targetCol);
-        setState(new MoveToTarget());
+        setState(MoveToTarget::instance());
     }
     else {
-        setState(new Idle());
+        setState(Idle::instance());
     }
 }
+
+// ============================================================
+// Event Scheduling
+// ============================================================
+void Agent::hashState(StateHash& h) const
+{
+    h.add(pos);
+    h.add(target);
+    h.add(int64_t(moving));
+    h.add(int64_t(alive));
+    h.add(hp);
+    h.add(int64_t(bullets));
+    h.add(int64_t(grenades));
+    h.add(path);
+    h.add(int64_t(pathIndex));
+    h.add(int64_t(nextStepFrame));
+    h.add(int64_t(windowSteps));
+    if (search.running()) h.add(int64_t(search.expanded())); // progress every tick: never idle
+    h.add(current);
+    h.add(interrupted);
+}
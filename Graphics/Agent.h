@@ -2,17 +2,23 @@
 #include "Definitions.h"
 #include "Types.h"
 #include "Order.h"
+#include "TimingWheel.h"
+#include "Grid.h"
+#include "Pathfinder.h"
 #include <vector>
 #include <algorithm>
 #include <cstdio>
 
 class State;
 class Map;
+class TeamRoster;
+class StateHash;
 
 class Agent {
 protected:
     // --- Core attributes ---
     TeamColor team;
+    AgentRole role;
     Vec2i pos;
     Vec2i target;
     bool moving = false;
@@ -28,29 +34,47 @@ protected:
     // --- Pathfinding and state ---
     std::vector<Vec2i> path;
     int pathIndex = -1;
-    int moveDelayCounter = 0;
-    static const int MOVE_DELAY = 80;
+    int nextStepFrame = 0;            // deadline on the match clock
+    PathSearch search;                // time-sliced query of MoveToTarget
+    int windowSteps = 0;              // path steps still reserved in the team's ReservationTable
+    static const int MOVE_DELAY = 80; // frames waited between steps
 
     State* current = nullptr;
     State* interrupted = nullptr;
+    static size_t transitions; // total setState() calls (diagnostics)
+    static size_t switchAllocations; // heap allocations made by setState() itself (must stay 0)
+    static size_t hookAllocations;   // heap allocations made by OnExit / OnEnter (path planning)
 
     // --- Visibility map ---
-    std::vector<uint8_t> vis;
+    Grid<uint8_t> vis;
+    Vec2i visMin{ 0, 0 }, visMax{ -1, -1 }; // window written by the last computeVisibility()
+
+    // --- Team roster (notified on death / revive) ---
+    TeamRoster* roster = nullptr;
+
+    int id = -1; // spawn index within the match
+
+    // --- Match clock (see TimingWheel) ---
+    static int now();
+    void armTimer(int& deadline, TimerKind kind, int delay); // deadline = now() + delay, wakeup registered
 
     // --- Internal helpers ---
+    void setAlive(bool v);
+    void setPos(const Vec2i& p);
+
     void takeDamage(int dmg) {
         hp = std::max(0.0, hp - dmg);
-        if (hp <= 0.0) alive = false;
+        if (hp <= 0.0) setAlive(false);
     }
 
     void heal() {
         hp = maxHP;
-        alive = true;
+        setAlive(true);
     }
 
 public:
     // --- Construction ---
-    Agent(TeamColor t, int r, int c);
+    Agent(TeamColor t, AgentRole role, int r, int c);
     virtual ~Agent();
 
     // --- Core behavior ---
@@ -64,7 +88,10 @@ public:
     bool advanceAlongPath(const Map& world);
 
     // --- State management ---
-    void setState(State* s);
+    void setState(State* s);   // s is a shared flyweight (e.g. Idle::instance())
+    static size_t transitionCount() { return transitions; }
+    static size_t transitionAllocations() { return switchAllocations; }
+    static size_t stateHookAllocations() { return hookAllocations; }
     void setInterrupted(State* s) { interrupted = s; }
     State* getState() { return current; }
     State* getInterrupted() { return interrupted; }
@@ -74,10 +101,18 @@ public:
         path = p;
         pathIndex = path.empty() ? -1 : 0;
         moving = !path.empty();
+        windowSteps = 0;
     }
 
     const std::vector<Vec2i>& getPath() const { return path; }
     int getPathIndex() const { return pathIndex; }
+    PathSearch& pathSearch() { return search; }
+
+    // --- Cooperative windows (see MoveToTarget::planWindows) ---
+    int reservedSteps() const { return windowSteps; }
+    void setReservedSteps(int n) { windowSteps = n; }
+    int nextStepAt() const { return nextStepFrame; }
+    static int stepPeriod() { return MOVE_DELAY + 1; }
 
     // --- Position access ---
     int row() const { return pos.r; }
@@ -88,6 +123,10 @@ public:
     // --- Team and identity ---
     virtual const char* roleLetter() const = 0;
     TeamColor getTeam() const { return team; }
+    AgentRole getRole() const { return role; }
+    void setRoster(TeamRoster* r) { roster = r; }
+    int getId() const { return id; }
+    void setId(int i) { id = i; }
 
     // --- Movement control ---
     bool isMoving() const { return moving; }
@@ -106,7 +145,7 @@ public:
 
     void healFull() {
         hp = 100.0;
-        alive = true;
+        setAlive(true);
         moving = false;
         path.clear();
         pathIndex = -1;
@@ -118,10 +157,11 @@ public:
         hp -= dmg;
         if (hp <= 0.0) {
             hp = 0.0;
-            alive = false;
+            setAlive(false);
             moving = false;
             path.clear();
             pathIndex = -1;
+            search.cancel();
 
             if (current)
                 current = nullptr;
@@ -136,12 +176,17 @@ public:
     void computeVisibility(const Map& world);
 
     bool canSee(int r, int c) const {
-        if (r < 0 || r >= MSZ || c < 0 || c >= MSZ) return false;
-        return !vis.empty() && vis[r * MSZ + c] != 0;
+        return vis.inBounds(r, c) && vis(r, c) != 0;
     }
 
-    const std::vector<uint8_t>& getVisibility() const { return vis; }
+    const Grid<uint8_t>& getVisibility() const { return vis; }
+    const Vec2i& visibilityMin() const { return visMin; } // window of the last computeVisibility()
+    const Vec2i& visibilityMax() const { return visMax; }
+    void mergeVisibilityInto(const Map& world, Grid<uint8_t>& out) const; // ORs the sight window into a same-shape grid
 
     // --- Orders ---
     virtual void receiveOrder(const Order& o);
+
+    // --- Event scheduling (headless fast-forward, see EventScheduler) ---
+    virtual void hashState(StateHash& h) const;
 };
@@ -0,0 +1,120 @@
+#include "AllocCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// ============================================================
+// Counters (relaxed atomics: totals only, no ordering needed)
+// ============================================================
+static std::atomic<size_t> gAllocs{ 0 };
+static std::atomic<size_t> gFrees{ 0 };
+static std::atomic<size_t> gBytes{ 0 };
+
+AllocCounter::Snapshot AllocCounter::now() {
+    Snapshot s;
+    s.allocations = gAllocs.load(std::memory_order_relaxed);
+    s.frees = gFrees.load(std::memory_order_relaxed);
+    s.bytes = gBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+AllocCounter::Snapshot AllocCounter::since(const Snapshot& before) {
+    Snapshot s = now();
+    s.allocations -= before.allocations;
+    s.frees -= before.frees;
+    s.bytes -= before.bytes;
+    return s;
+}
+
+// ============================================================
+// Global operator new / delete replacements
+// ============================================================
+static void* countedAlloc(size_t n) {
+    gAllocs.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    if (n == 0) n = 1;
+    return std::malloc(n);
+}
+
+static void countedFree(void* p) {
+    if (!p) return;
+    gFrees.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+void* operator new(size_t n) {
+    void* p = countedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t n) {
+    void* p = countedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+
+// ============================================================
+// Aligned forms (over-aligned types, C++17 and later)
+// ============================================================
+#if defined(__cpp_aligned_new)
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+static void* countedAlignedAlloc(size_t n, std::align_val_t align) {
+    gAllocs.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    if (n == 0) n = 1;
+    size_t a = static_cast<size_t>(align);
+#if defined(_MSC_VER)
+    return _aligned_malloc(n, a);
+#else
+    if (a < sizeof(void*)) a = sizeof(void*);
+    void* p = nullptr;
+    return (posix_memalign(&p, a, n) == 0) ? p : nullptr;
+#endif
+}
+
+static void countedAlignedFree(void* p) {
+    if (!p) return;
+    gFrees.fetch_add(1, std::memory_order_relaxed);
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t n, std::align_val_t a) {
+    void* p = countedAlignedAlloc(n, a);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t n, std::align_val_t a) {
+    void* p = countedAlignedAlloc(n, a);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return countedAlignedAlloc(n, a); }
+void* operator new[](size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return countedAlignedAlloc(n, a); }
+
+void operator delete(void* p, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedAlignedFree(p); }
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+// ============================================================
+// AllocCounter.h
+// Process-wide heap allocation counters. AllocCounter.cpp
+// replaces the global operator new / delete (the aligned forms
+// too, where the compiler has them), so any code path
+// can be checked for hidden allocations by diffing snapshots:
+//
+//     AllocCounter::Snapshot before = AllocCounter::now();
+//     ... work ...
+//     size_t n = AllocCounter::since(before).allocations;
+// ============================================================
+namespace AllocCounter {
+
+    struct Snapshot {
+        size_t allocations = 0; // operator new calls
+        size_t frees = 0;       // operator delete calls (non-null)
+        size_t bytes = 0;       // bytes requested through operator new
+    };
+
+    // Current totals since program start
+    Snapshot now();
+
+    // Difference between now() and an earlier snapshot
+    Snapshot since(const Snapshot& before);
+}
@@ -0,0 +1,400 @@
+#include "Bench.h"
+#include "Map.h"
+#include "Grid.h"
+#include "GridKernels.h"
+#include "BitBfs.h"
+#include "Landmarks.h"
+#include "Pathfinder.h"
+#include "Reservations.h"
+#include "FlowField.h"
+#include "Definitions.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+// ============================================================
+// Helpers
+// ============================================================
+typedef std::chrono::steady_clock BenchClock;
+
+static double elapsedNs(BenchClock::time_point t0) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - t0).count();
+}
+
+static void report(const char* name, double ns, long long ops, long long checksum) {
+    std::printf("  %-18s %10.1f ns/op  (%lld ops, check %lld)\n",
+        name, ops > 0 ? ns / ops : 0.0, ops, checksum);
+}
+
+static void reportSearch(const char* name, double ns, long long ops, long long nodes, long long checksum) {
+    std::printf("  %-18s %10.1f ns/op  %8.1f nodes/op  (%lld ops, check %lld)\n",
+        name, ops > 0 ? ns / ops : 0.0, ops > 0 ? double(nodes) / ops : 0.0, ops, checksum);
+}
+
+// Random passable cell (fixed sequence for a given seed)
+static Vec2i randomFreeCell(const Map& world) {
+    while (true) {
+        Vec2i p{ rand() % world.rows(), rand() % world.cols() };
+        if (!world.blocksMovement(p.r, p.c)) return p;
+    }
+}
+
+// Agents sharing a cell at some step 0..horizon (an agent stays on
+// the last cell of its path). Paths hold one cell per step.
+static long long vertexConflicts(const std::vector<Vec2i>& starts,
+    const std::vector<std::vector<Vec2i>>& paths, int horizon)
+{
+    long long conflicts = 0;
+    std::unordered_map<long long, int> seen;
+    for (int t = 0; t <= horizon; ++t) {
+        seen.clear();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const std::vector<Vec2i>& p = paths[i];
+            const Vec2i& at = (t == 0 || p.empty()) ? starts[i] : p[std::min(t, (int)p.size()) - 1];
+            if (seen[((long long)at.r << 32) | (unsigned)at.c]++ > 0) ++conflicts;
+        }
+    }
+    return conflicts;
+}
+
+// ============================================================
+// Entry point
+// ============================================================
+int runBench(int rows, int cols, unsigned seed) {
+    srand(seed);
+    Map world(rows, cols);
+    world.initStructured();
+
+    const GridKernels& k = world.kernels();
+    const TerrainBits terrain = world.terrainBits();
+    std::printf("bench: map %dx%d  (kernels: %s, seed %u)\n", rows, cols, k.name, seed);
+
+    std::vector<Vec2i> origins(4096);
+    for (auto& p : origins) p = randomFreeCell(world);
+
+    // --- Vertical LOS rays (one map row per step) ---
+    {
+        long long ops = 0, hits = 0;
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 16; ++rep)
+            for (const Vec2i& o : origins) {
+                Vec2i to = world.clampCell(o.r + ((rep & 1) ? 64 : -64), o.c);
+                hits += k.lineOfSight(terrain, o, to);
+                ++ops;
+            }
+        report("los vertical", elapsedNs(t0), ops, hits);
+    }
+
+    // --- Random LOS rays within sight range ---
+    {
+        long long ops = 0, hits = 0;
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 64; ++rep)
+            for (const Vec2i& o : origins) {
+                Vec2i to = world.clampCell(o.r + rand() % 25 - 12, o.c + rand() % 25 - 12);
+                hits += k.lineOfSight(terrain, o, to);
+                ++ops;
+            }
+        report("los random", elapsedNs(t0), ops, hits);
+    }
+
+    // --- Sight discs (Agent::computeVisibility without the window clear) ---
+    {
+        Grid<uint8_t> vis(rows, cols, 0);
+        long long ops = 0;
+        auto t0 = BenchClock::now();
+        for (const Vec2i& o : origins) {
+            k.sight(terrain, o, SIGHT_RANGE, vis.data());
+            ++ops;
+        }
+        double ns = elapsedNs(t0);
+        long long seen = 0;
+        vis.forEach([&seen](int, int, uint8_t& v) { seen += v; });
+        report("sight disc", ns, ops, seen);
+    }
+
+    // --- Danger stamps (SafetyMap::compute per enemy) ---
+    {
+        Grid<int> danger(rows, cols, 0);
+        long long ops = 0;
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 16; ++rep) {
+            danger.fill(0);
+            for (const Vec2i& o : origins) {
+                k.stampDanger(danger.data(), rows, cols, o);
+                ++ops;
+            }
+        }
+        double ns = elapsedNs(t0);
+        long long sum = 0;
+        danger.forEach([&sum](int, int, int& v) { sum += v; });
+        report("danger stamp", ns, ops, sum);
+    }
+
+    // --- Cover search (Warrior::findBestCoverNear, radius 6) ---
+    {
+        long long ops = 0, found = 0;
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 16; ++rep)
+            for (const Vec2i& o : origins) {
+                Vec2i cover;
+                if (k.findCover(terrain, o, 6, cover)) found += cover.r + cover.c;
+                ++ops;
+            }
+        report("cover search", elapsedNs(t0), ops, found);
+    }
+
+    // --- A* between random free cells ---
+    {
+        std::vector<Vec2i> path;
+        long long ops = 0, steps = 0;
+        auto t0 = BenchClock::now();
+        for (int i = 0; i + 1 < 128; i += 2) {
+            if (k.aStar(terrain, origins[i], origins[i + 1], path, nullptr, nullptr))
+                steps += (long long)path.size();
+            ++ops;
+        }
+        report("a* random pair", elapsedNs(t0), ops, steps);
+    }
+
+    // --- Landmark (ALT) heuristic against plain Manhattan ---
+    // Same pairs, without and with a danger field of one enemy per 160
+    // cells; the checks are total path costs and must match.
+    {
+        Landmarks lm;
+        auto t0 = BenchClock::now();
+        lm.update(world, 0.0);
+        report("landmark build", elapsedNs(t0), 1, (long long)lm.cells().size());
+        std::printf("  %-18s %10.3f\n", "terrain detour", lm.detour());
+        const LandmarkView view = lm.view();
+
+        Grid<int> danger(rows, cols, 0);
+        const int nEnemies = std::min(2048, std::max(1, rows * cols / 160));
+        for (int i = 0; i < nEnemies; ++i)
+            k.stampDanger(danger.data(), rows, cols, origins[origins.size() - 1 - i]);
+
+        struct Variant { const char* name; const int* danger; const LandmarkView* lm; };
+        const Variant variants[] = {
+            { "a* manhattan", nullptr, nullptr },
+            { "a* landmarks", nullptr, &view },
+            { "a* danger manh.", danger.data(), nullptr },
+            { "a* danger landm.", danger.data(), &view },
+        };
+
+        std::vector<Vec2i> path;
+        for (const Variant& v : variants) {
+            long long ops = 0, cost = 0;
+            const long long nodes0 = aStarExpansions();
+            t0 = BenchClock::now();
+            for (int i = 0; i + 1 < 128; i += 2) {
+                if (k.aStar(terrain, origins[i], origins[i + 1], path, v.danger, v.lm))
+                    for (const Vec2i& p : path)
+                        cost += v.danger ? 1 + std::min(10, danger(p.r, p.c) / 10) : 1;
+                ++ops;
+            }
+            double ns = elapsedNs(t0);
+            reportSearch(v.name, ns, ops, aStarExpansions() - nodes0, cost);
+        }
+
+        // Cross-map pairs (at least half the map's rows + cols apart),
+        // one-ended against bidirectional; the checks are path lengths
+        std::vector<Vec2i> from, to;
+        const int longDist = std::max(BIDIRECTIONAL_MIN_DISTANCE, (rows + cols) / 2);
+        for (size_t i = 0; i < origins.size() && from.size() < 64; ++i)
+            for (size_t j = i + 1; j < origins.size() && from.size() < 64; j += 97)
+                if (std::abs(origins[i].r - origins[j].r) + std::abs(origins[i].c - origins[j].c) >= longDist
+                    && world.connected(origins[i], origins[j])) {
+                    from.push_back(origins[i]);
+                    to.push_back(origins[j]);
+                    break;
+                }
+
+        struct LongVariant { const char* name; bool both; const LandmarkView* lm; };
+        const LongVariant longVariants[] = {
+            { "a* long one-ended", false, nullptr },
+            { "a* long bidir.", true, nullptr },
+            { "a* long landm.", false, &view },
+            { "a* long bidir. lm.", true, &view },
+        };
+        for (const LongVariant& v : longVariants) {
+            long long ops = 0, len = 0;
+            const long long nodes0 = aStarExpansions();
+            t0 = BenchClock::now();
+            for (size_t i = 0; i < from.size(); ++i) {
+                bool ok = v.both ? k.aStarBidirectional(terrain, from[i], to[i], path, v.lm)
+                                 : k.aStar(terrain, from[i], to[i], path, nullptr, v.lm);
+                if (ok) len += (long long)path.size();
+                ++ops;
+            }
+            double ns = elapsedNs(t0);
+            reportSearch(v.name, ns, ops, aStarExpansions() - nodes0, len);
+        }
+    }
+
+    // --- Time-sliced A* (PathSearch, PATH_NODE_BUDGET nodes per step) ---
+    // Same pairs; the worst single step is what one agent can add to a tick.
+    // A first query outside the timing labels components and probes the
+    // landmarks, which the game pays once per terrain.
+    {
+        PathSearch search;
+        std::vector<Vec2i> path;
+        if (search.begin(world, origins[0], origins[1], nullptr, PATH_NODE_BUDGET) == PathSearch::SEARCH_RUNNING)
+            while (search.step(PATH_NODE_BUDGET) == PathSearch::SEARCH_RUNNING) {}
+
+        long long ops = 0, steps = 0, len = 0;
+        double worst = 0.0;
+        auto t0 = BenchClock::now();
+        for (int i = 0; i + 1 < 128; i += 2) {
+            auto t1 = BenchClock::now();
+            PathSearch::Status st = search.begin(world, origins[i], origins[i + 1], nullptr, PATH_NODE_BUDGET);
+            worst = std::max(worst, elapsedNs(t1));
+            while (st == PathSearch::SEARCH_RUNNING) {
+                t1 = BenchClock::now();
+                st = search.step(PATH_NODE_BUDGET);
+                worst = std::max(worst, elapsedNs(t1));
+                ++steps;
+            }
+            if (search.routeFrom(origins[i], path)) len += (long long)path.size();
+            ++ops;
+        }
+        report("a* sliced", elapsedNs(t0), ops, len);
+        std::printf("  %-18s %10.1f steps/op  worst step %.1f us\n", "", ops > 0 ? double(steps) / ops : 0.0, worst / 1000.0);
+    }
+
+    // --- Cooperative windows (WHCA*): one team's batch per tick ---
+    // N agents on distinct cells, random goals, planned one after another
+    // against a shared ReservationTable, against each planned alone. The
+    // independent pass runs first and leaves the spatial paths cached, as
+    // in a match; the checks are agents sharing a cell within the window.
+    {
+        const int sizes[] = { 64, 256, 512 };
+        for (int n : sizes) {
+            std::vector<Vec2i> starts, goals;
+            std::unordered_map<long long, bool> taken;
+            for (const Vec2i& p : origins) {
+                if ((int)starts.size() == n) break;
+                if (taken[((long long)p.r << 32) | (unsigned)p.c]) continue;
+                taken[((long long)p.r << 32) | (unsigned)p.c] = true;
+                starts.push_back(p);
+            }
+            for (size_t i = 0; i < starts.size(); ++i) {
+                Vec2i g = randomFreeCell(world);
+                while (!world.connected(starts[i], g)) g = randomFreeCell(world);
+                goals.push_back(g);
+            }
+
+            std::vector<std::vector<Vec2i>> paths(starts.size());
+            auto t0 = BenchClock::now();
+            for (size_t i = 0; i < starts.size(); ++i)
+                Pathfinder::AStar(world, starts[i], goals[i], paths[i]);
+            double ns = elapsedNs(t0);
+            char name[32];
+            std::snprintf(name, sizeof(name), "a* alone x%d", (int)starts.size());
+            report(name, ns, (long long)starts.size(), vertexConflicts(starts, paths, COOP_WINDOW));
+
+            ReservationTable table;
+            const StepClock clock{ 0, 1, 1 };
+            long long reserved = 0;
+            t0 = BenchClock::now();
+            for (size_t i = 0; i < starts.size(); ++i) {
+                int steps = 0;
+                Pathfinder::AStarWindow(world, table, (int)i, clock, starts[i], goals[i], COOP_WINDOW,
+                    paths[i], steps);
+                reserved += steps;
+            }
+            ns = elapsedNs(t0);
+            std::snprintf(name, sizeof(name), "whca* batch x%d", (int)starts.size());
+            report(name, ns, (long long)starts.size(), vertexConflicts(starts, paths, COOP_WINDOW));
+            std::printf("  %-18s %10.1f steps reserved/op  (%zu reservations)\n", "",
+                double(reserved) / starts.size(), table.reservations());
+        }
+    }
+
+    // --- Squad orders: one flow field per target against A* per warrior ---
+    // Squads of N on random cells sent to one random target (danger-free
+    // costs); ns/op is per warrior, the checks are total path lengths.
+    {
+        Landmarks lm;
+        lm.update(world, 0.0);
+        const LandmarkView view = lm.view();
+        const int squads[] = { 2, 8, 16, 32, 64, 128 };
+        for (int n : squads) {
+            std::vector<std::vector<Vec2i>> members(8);
+            std::vector<Vec2i> targets(8);
+            for (size_t s = 0; s < members.size(); ++s) {
+                targets[s] = randomFreeCell(world);
+                while ((int)members[s].size() < n) {
+                    Vec2i p = randomFreeCell(world);
+                    if (world.connected(p, targets[s])) members[s].push_back(p);
+                }
+            }
+
+            std::vector<Vec2i> path;
+            long long ops = 0, len = 0;
+            auto t0 = BenchClock::now();
+            for (size_t s = 0; s < members.size(); ++s)
+                for (const Vec2i& p : members[s]) {
+                    if (k.aStar(terrain, p, targets[s], path, nullptr, &view)) len += (long long)path.size();
+                    ++ops;
+                }
+            double ns = elapsedNs(t0);
+            char name[32];
+            std::snprintf(name, sizeof(name), "a* each x%d", n);
+            report(name, ns, ops, len);
+
+            FlowField field;
+            ops = 0;
+            len = 0;
+            t0 = BenchClock::now();
+            for (size_t s = 0; s < members.size(); ++s) {
+                field.build(world, targets[s], members[s], nullptr);
+                for (const Vec2i& p : members[s]) {
+                    if (field.walk(p, path)) len += (long long)path.size();
+                    ++ops;
+                }
+            }
+            ns = elapsedNs(t0);
+            std::snprintf(name, sizeof(name), "squad field x%d", n);
+            report(name, ns, ops, len);
+        }
+    }
+
+    // --- Distance field from one storage (what a landmark table costs) ---
+    {
+        Grid<int> dist;
+        std::vector<Vec2i> sources(1, world.ammoStorage(TEAM_ORANGE));
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 4; ++rep)
+            BitBfs::distanceField(world, sources, dist);
+        double ns = elapsedNs(t0);
+        long long far = 0;
+        dist.forEach([&far](int, int, int& d) { far = std::max(far, (long long)d); });
+        report("bfs distance field", ns, 4, far);
+    }
+
+    // --- Component index: labelling the map, then lookups ---
+    // The searches above already labelled 'world', so the labelling is
+    // timed on its own grids (what Map does when its terrain changes).
+    {
+        Grid<int> labels;
+        std::vector<int> sizes;
+        auto t0 = BenchClock::now();
+        for (int rep = 0; rep < 4; ++rep)
+            BitBfs::labelComponents(world, labels, sizes);
+        report("component label", elapsedNs(t0), 4, (long long)sizes.size());
+
+        long long ops = 0, hits = 0;
+        t0 = BenchClock::now();
+        for (int rep = 0; rep < 16; ++rep)
+            for (size_t i = 0; i + 1 < origins.size(); i += 2) {
+                hits += world.connected(origins[i], origins[i + 1]);
+                ++ops;
+            }
+        report("component query", elapsedNs(t0), ops, hits);
+    }
+
+    return 0;
+}
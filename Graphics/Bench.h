@@ -0,0 +1,15 @@
+#pragma once
+
+// ============================================================
+// Bench.h
+// Micro-benchmarks for the grid kernels on a generated map
+// (battle --bench [--size N] [--seed S]). Each workload touches
+// the map the way the simulation does - vertical and random LOS
+// rays, sight discs, danger stamps, cover search, A* queries,
+// landmark heuristics, bidirectional and time-sliced A*,
+// cooperative (WHCA*) batches of hundreds of agents, squad flow
+// fields, bitboard floods - and reports time per operation (and
+// nodes expanded for searches), so layout changes can be compared
+// on large maps.
+// ============================================================
+int runBench(int rows, int cols, unsigned seed);
@@ -0,0 +1,193 @@
+#include "BitBfs.h"
+#include "Map.h"
+#include <algorithm>
+
+// ============================================================
+// Flood state (scratch, sized to the map)
+// ============================================================
+namespace {
+
+struct Flood {
+    const Bitboard* blockers = nullptr; // world.moveBlockers()
+    Bitboard visited;
+    int vLo = 0, vHi = -1;              // rows with visited bits
+    std::vector<uint64_t> rowPass;      // one-row scratch
+    std::vector<uint64_t> rowBits;
+
+    // Only rows touched by the previous flood are cleared, so a small
+    // component stays cheap on a large map.
+    void begin(const Map& world) {
+        const int R = world.rows(), C = world.cols();
+        if (visited.rows() != R || visited.cols() != C)
+            visited.resize(R, C);
+        else
+            for (int r = vLo; r <= vHi; ++r)
+                std::fill(visited.row(r), visited.row(r) + visited.wordsPerRow(), uint64_t(0));
+
+        blockers = &world.moveBlockers();
+        vLo = 0;
+        vHi = -1;
+    }
+};
+
+Flood gFlood;
+
+// --- Row run fill ---
+// Extends 'x' through the passable runs of one row it touches
+// (occluded Kogge-Stone fill, both directions, carried across words).
+void fillRow(uint64_t* x, const uint64_t* passable, int W) {
+    uint64_t carry = 0;
+    for (int k = 0; k < W; ++k) {            // toward higher columns
+        uint64_t gen = x[k] | (carry & passable[k]), pro = passable[k];
+        gen |= pro & (gen << 1);  pro &= pro << 1;
+        gen |= pro & (gen << 2);  pro &= pro << 2;
+        gen |= pro & (gen << 4);  pro &= pro << 4;
+        gen |= pro & (gen << 8);  pro &= pro << 8;
+        gen |= pro & (gen << 16); pro &= pro << 16;
+        gen |= pro & (gen << 32);
+        x[k] = gen;
+        carry = gen >> 63;
+    }
+    carry = 0;
+    for (int k = W - 1; k >= 0; --k) {       // toward lower columns
+        uint64_t gen = x[k] | ((carry << 63) & passable[k]), pro = passable[k];
+        gen |= pro & (gen >> 1);  pro &= pro >> 1;
+        gen |= pro & (gen >> 2);  pro &= pro >> 2;
+        gen |= pro & (gen >> 4);  pro &= pro >> 4;
+        gen |= pro & (gen >> 8);  pro &= pro >> 8;
+        gen |= pro & (gen >> 16); pro &= pro >> 16;
+        gen |= pro & (gen >> 32);
+        x[k] = gen;
+        carry = gen & 1;
+    }
+}
+
+// --- Component flood ---
+// Alternating down / up sweeps: each row takes in what its neighbour
+// rows reached, then fills its own runs. A sweep carries reach along
+// whole runs and across any number of rows, so the number of sweeps
+// follows the turns of the winding paths, not their length.
+void floodComponent(Flood& f, const Vec2i& from) {
+    const int R = f.visited.rows();
+    const int W = f.visited.wordsPerRow();
+    const uint64_t lastMask = f.visited.wordMask(W - 1);
+    f.rowPass.resize(W);
+    f.rowBits.resize(W);
+    uint64_t* passable = f.rowPass.data();
+    uint64_t* x = f.rowBits.data();
+
+    // Row r takes in its neighbour rows; false if nothing new arrived
+    auto grow = [&](int r, bool force) -> bool {
+        const uint64_t* b = f.blockers->row(r);
+        const uint64_t* up = (r > 0) ? f.visited.row(r - 1) : nullptr;
+        const uint64_t* dn = (r + 1 < R) ? f.visited.row(r + 1) : nullptr;
+        uint64_t* v = f.visited.row(r);
+
+        uint64_t fresh = 0;
+        for (int k = 0; k < W; ++k) {
+            passable[k] = ~b[k] & (k == W - 1 ? lastMask : ~uint64_t(0));
+            x[k] = v[k] | (((up ? up[k] : 0) | (dn ? dn[k] : 0)) & passable[k]);
+            fresh |= x[k] & ~v[k];
+        }
+        if (!fresh && !force) return false;
+
+        fillRow(x, passable, W);
+        for (int k = 0; k < W; ++k) v[k] = x[k];
+        f.vLo = std::min(f.vLo, r);
+        f.vHi = std::max(f.vHi, r);
+        return true;
+    };
+
+    f.visited.set(from.r, from.c, true);
+    f.vLo = f.vHi = from.r;
+    grow(from.r, true);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int r = std::max(0, f.vLo - 1); r <= std::min(R - 1, f.vHi + 1); ++r)
+            changed |= grow(r, false);
+        for (int r = std::min(R - 1, f.vHi + 1); r >= std::max(0, f.vLo - 1); --r)
+            changed |= grow(r, false);
+    }
+}
+
+} // namespace
+
+// ============================================================
+// Component labels
+// Each flood labels one whole component; the next one starts at
+// the first passable cell no flood has reached, found a word at a
+// time, so labels come out in the row-major order of those cells.
+// ============================================================
+void BitBfs::labelComponents(const Map& world, Grid<int>& labels, std::vector<int>& sizes) {
+    const int R = world.rows(), C = world.cols();
+    if (!labels.sameShape(R, C))
+        labels.resize(R, C, -1);
+    else
+        labels.fill(-1);
+    sizes.clear();
+
+    Flood& f = gFlood;
+    Bitboard done;
+    done.resize(R, C);
+    const Bitboard& blockers = world.moveBlockers();
+    const int W = done.wordsPerRow();
+
+    for (int r = 0; r < R; ++r)
+        for (int k = 0; k < W; ++k) {
+            uint64_t open;
+            while ((open = ~blockers.row(r)[k] & ~done.row(r)[k] & done.wordMask(k)) != 0) {
+                const int label = (int)sizes.size();
+                int cells = 0;
+                f.begin(world);
+                floodComponent(f, { r, k * 64 + lowestBit(open) });
+                for (int rr = f.vLo; rr <= f.vHi; ++rr) {
+                    const uint64_t* v = f.visited.row(rr);
+                    uint64_t* d = done.row(rr);
+                    for (int j = 0; j < W; ++j) {
+                        d[j] |= v[j];
+                        for (uint64_t m = v[j]; m; m &= m - 1) {
+                            labels(rr, j * 64 + lowestBit(m)) = label;
+                            ++cells;
+                        }
+                    }
+                }
+                sizes.push_back(cells);
+            }
+        }
+}
+
+// ============================================================
+// Distance field
+// A plain queue BFS: a layer of a bitboard flood sweeps every word
+// of the rows it spans, which costs more than visiting the cells
+// once a wavefront is wide.
+// ============================================================
+void BitBfs::distanceField(const Map& world, const std::vector<Vec2i>& sources, Grid<int>& dist) {
+    if (!dist.sameShape(world.rows(), world.cols()))
+        dist.resize(world.rows(), world.cols(), -1);
+    else
+        dist.fill(-1);
+
+    static const int DR[4] = { -1, 1, 0, 0 };
+    static const int DC[4] = { 0, 0, -1, 1 };
+    static std::vector<Vec2i> queue;
+    queue.clear();
+    for (const Vec2i& s : sources) {
+        if (!world.inBounds(s.r, s.c) || dist(s.r, s.c) == 0) continue;
+        dist(s.r, s.c) = 0;
+        queue.push_back(s);
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const Vec2i p = queue[head];
+        const int next = dist(p.r, p.c) + 1;
+        for (int k = 0; k < 4; ++k) {
+            const int r = p.r + DR[k], c = p.c + DC[k];
+            if (!world.inBounds(r, c) || world.blocksMovement(r, c) || dist(r, c) >= 0) continue;
+            dist(r, c) = next;
+            queue.push_back({ r, c });
+        }
+    }
+}
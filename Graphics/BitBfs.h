@@ -0,0 +1,32 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "Bitboard.h"
+#include <vector>
+
+// Forward declaration
+class Map;
+
+// ============================================================
+// BitBfs
+// Uniform-cost (4-neighbour) floods over the movement bitboard.
+// Connected components use bit-parallel row sweeps: a row takes
+// in what its neighbour rows reached, then fills its own passable
+// runs with shift / AND / OR, 64 cells per instruction. Sweeping
+// rows down and up until nothing changes takes a number of sweeps
+// that follows the turns of the paths, not their length, and only
+// the rows a flood reaches are touched.
+// Distance fields need every layer, so they are built by a plain
+// queue BFS. Sources count as reached even when they are not
+// passable (an agent's own cell), the same as the A* start node.
+// ============================================================
+class BitBfs {
+public:
+    // Component of every cell: 0, 1, ... in the row-major order of each
+    // component's first cell, -1 where movement is blocked. 'sizes'
+    // gets the cell count per label (Map::componentOf).
+    static void labelComponents(const Map& world, Grid<int>& labels, std::vector<int>& sizes);
+
+    // Steps from the nearest source to every cell, -1 where unreachable
+    static void distanceField(const Map& world, const std::vector<Vec2i>& sources, Grid<int>& dist);
+};
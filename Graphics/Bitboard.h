@@ -0,0 +1,70 @@
+#pragma once
+#include "Grid.h"
+#include <vector>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ============================================================
+// Bitboard.h
+// One bit per map cell, stored as rows of 64-bit words: cell
+// (r, c) is bit (c & 63) of word (c >> 6) of row r. Bits past
+// the last column are always 0. Row-word access lets a scan
+// test 64 neighbouring cells with one instruction.
+// ============================================================
+
+// Index of the lowest set bit (v != 0)
+inline int lowestBit(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+class Bitboard {
+public:
+    void resize(int rows, int cols) {
+        nRows = rows;
+        nCols = cols;
+        nWords = (cols + 63) >> 6;
+        words.assign(size_t(rows) * size_t(nWords), 0);
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    int wordsPerRow() const { return nWords; }
+
+    void clear() { std::fill(words.begin(), words.end(), uint64_t(0)); }
+
+    // --- Single cells (no bounds checks) ---
+    bool test(int r, int c) const {
+        return (words[size_t(r) * nWords + (c >> 6)] >> (c & 63)) & 1;
+    }
+
+    void set(int r, int c, bool v) {
+        uint64_t& w = words[size_t(r) * nWords + (c >> 6)];
+        const uint64_t bit = uint64_t(1) << (c & 63);
+        w = v ? (w | bit) : (w & ~bit);
+    }
+
+    // --- Row words ---
+    uint64_t* row(int r) { return words.data() + size_t(r) * nWords; }
+    const uint64_t* row(int r) const { return words.data() + size_t(r) * nWords; }
+    const uint64_t* data() const { return words.data(); }
+
+    // Valid-column mask of row word k (the last word is partial)
+    uint64_t wordMask(int k) const {
+        int bits = nCols - k * 64;
+        return bits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+    }
+
+private:
+    int nRows = 0;
+    int nCols = 0;
+    int nWords = 0;
+    std::vector<uint64_t, CacheAlignedAllocator<uint64_t>> words;
+};
@@ -1 +0,0 @@
-#include "Bullet.h"
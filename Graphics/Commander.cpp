@@ -10,6 +10,8 @@
 #include "SafetyMap.h"
 #include "Pathfinder.h"
 #include "MoveToTarget.h"
+#include "TeamRoster.h"
+#include "EventScheduler.h"
 
 #include <cstdlib>
 #include <ctime>
@@ -25,6 +27,8 @@ extern std::vector<Agent*> gTeamOrange;
 extern std::vector<Agent*> gTeamBlue;
 extern SafetyMap* gDangerOrange;
 extern SafetyMap* gDangerBlue;
+extern TeamRoster* gRosterOrange;
+extern TeamRoster* gRosterBlue;
 
 // ------------------------------------------------------------
 // Utility
@@ -39,32 +43,18 @@ static inline T clampValue(T v, T lo, T hi) {
 // ------------------------------------------------------------
 // Constructor
 // ------------------------------------------------------------
-Commander::Commander(TeamColor t, int r, int c) : Agent(t, r, c) {
-    srand((unsigned)time(nullptr));
-}
+Commander::Commander(TeamColor t, int r, int c) : Agent(t, ROLE_COMMANDER, r, c) {}
 
 // ------------------------------------------------------------
 // Order Management API
 // ------------------------------------------------------------
 void Commander::addOrder(const Order& o) {
-    orders.push_back(o); // normal priority
-}
-
-void Commander::addPriorityOrder(const Order& o) {
-    orders.push_front(o); // high priority (used for HEAL)
-}
-
-bool Commander::hasPendingHeal() const {
-    for (const auto& o : orders)
-        if (o.type == OrderType::HEAL)
-            return true;
-    return false;
+    orders.push(o); // replaces any pending order for the same role
 }
 
 Order Commander::nextOrder() {
-    if (orders.empty()) return Order();
-    Order o = orders.front();
-    orders.pop_front();
+    Order o;
+    if (!orders.pop(o)) return Order();
     return o;
 }
 
@@ -77,28 +67,24 @@ void Commander::update(Map& world) {
     std::vector<Agent*>& myTeam = (getTeam() == TEAM_ORANGE) ? gTeamOrange : gTeamBlue;
     std::vector<Agent*>& enemies = (getTeam() == TEAM_ORANGE) ? gTeamBlue : gTeamOrange;
 
-    updateCombinedVisibility(myTeam);
-    issueSupportOrders(myTeam);
+    updateCombinedVisibility(world, myTeam);
+    issueSupportOrders();
     relocateIfInDanger(world, enemies);
 }
 
 // ------------------------------------------------------------
 // Commander Logic (high-level AI decision-making)
 // ------------------------------------------------------------
-void Commander::updateCommanderLogic() {
-    static int frames = 0;
-    frames++;
-    if (frames < 180) return;       // initial delay
-    if (frames % 600 != 0) return;  // periodic update
+void Commander::scheduleThink() {
+    armTimer(thinkFrame, TIMER_THINK, THINK_PERIOD);
+}
 
+void Commander::updateCommanderLogic() {
     std::vector<Agent*>& enemies = (getTeam() == TEAM_ORANGE) ? gTeamBlue : gTeamOrange;
-    std::vector<Agent*>& myTeam = (getTeam() == TEAM_ORANGE) ? gTeamOrange : gTeamBlue;
+    const TeamRoster& enemyRoster = (getTeam() == TEAM_ORANGE) ? *gRosterBlue : *gRosterOrange;
 
     // --- Check if all enemy warriors are eliminated ---
-    bool enemyWarriorsAlive = false;
-    for (auto* e : enemies)
-        if (e->isAlive() && dynamic_cast<Warrior*>(e))
-            enemyWarriorsAlive = true;
+    bool enemyWarriorsAlive = enemyRoster.anyAlive(ROLE_WARRIOR);
 
     if (!enemyWarriorsAlive) {
         bool anyEnemyAlive = false;
@@ -111,9 +97,9 @@ void Commander::updateCommanderLogic() {
     
         if (!anyEnemyAlive) {
             // move forward ORANGE team to enemy base area
-            int r = (getTeam() == TEAM_ORANGE) ? MSZ - 8 : 8;
-            int c = (getTeam() == TEAM_ORANGE) ? MSZ - 8 : 8;
-            addOrder(Order(OrderType::ATTACK, r, c));
+            TeamColor enemyTeam = (getTeam() == TEAM_ORANGE) ? TEAM_BLUE : TEAM_ORANGE;
+            Vec2i target = gWorldForStates->rallyCorner(enemyTeam, 8);
+            addOrder(Order(OrderType::ATTACK, target.r, target.c));
             /*printf("🏁 Commander %s: all enemies dead → final assault towards enemy base!\n",
                 getTeam() == TEAM_ORANGE ? "Orange" : "Blue");*/
         }
@@ -125,29 +111,26 @@ void Commander::updateCommanderLogic() {
     }
 
     // --- If any enemies exist, ensure attack orders are present ---
-    bool anyEnemyAlive = false;
-    for (auto* e : enemies)
-        if (e->isAlive()) {
-            anyEnemyAlive = true;
-            break;
-        }
+    bool anyEnemyAlive = enemyRoster.aliveTotal() > 0;
 
     if (anyEnemyAlive)
         addOrder(Order(OrderType::ATTACK, enemies[0]->row(), enemies[0]->col()));
 
     // --- Randomly issue strategic order ---
-    int roll = rand() % 4;
+    int roll = simRand() % 4;
     if (roll <= 1) {
         // 🎯 Randomized attack position per warrior
-        int baseR = (getTeam() == TEAM_ORANGE) ? MSZ - 10 : 5;
-        int baseC = (getTeam() == TEAM_ORANGE) ? MSZ - 10 : 5;
+        Vec2i base = (getTeam() == TEAM_ORANGE)
+            ? gWorldForStates->rallyCorner(TEAM_BLUE, 10)
+            : gWorldForStates->rallyCorner(TEAM_ORANGE, 5);
 
         // Add small random offset so each warrior takes a different path
-        int offsetR = (rand() % 7) - 3;  // -3..+3
-        int offsetC = (rand() % 7) - 3;
+        int offsetR = (simRand() % 7) - 3;  // -3..+3
+        int offsetC = (simRand() % 7) - 3;
 
-        int finalR = std::max(0, std::min(MSZ - 1, baseR + offsetR));
-        int finalC = std::max(0, std::min(MSZ - 1, baseC + offsetC));
+        Vec2i fin = gWorldForStates->clampCell(base.r + offsetR, base.c + offsetC);
+        int finalR = fin.r;
+        int finalC = fin.c;
 
         addOrder(Order(OrderType::ATTACK, finalR, finalC));
 
@@ -156,12 +139,12 @@ void Commander::updateCommanderLogic() {
     }
 
     else if (roll == 2) {
-        int baseR = (getTeam() == TEAM_ORANGE) ? 8 : MSZ - 8;
-        int baseC = (getTeam() == TEAM_ORANGE) ? 8 : MSZ - 8;
-        int offsetR = (rand() % 5) - 2;
-        int offsetC = (rand() % 5) - 2;
-        int finalR = std::max(0, std::min(MSZ - 1, baseR + offsetR));
-        int finalC = std::max(0, std::min(MSZ - 1, baseC + offsetC));
+        Vec2i base = gWorldForStates->rallyCorner(getTeam(), 8);
+        int offsetR = (simRand() % 5) - 2;
+        int offsetC = (simRand() % 5) - 2;
+        Vec2i fin = gWorldForStates->clampCell(base.r + offsetR, base.c + offsetC);
+        int finalR = fin.r;
+        int finalC = fin.c;
 
         addOrder(Order(OrderType::DEFEND, finalR, finalC));
 
@@ -173,53 +156,63 @@ void Commander::updateCommanderLogic() {
 
 // ------------------------------------------------------------
 // Order Dispatching
+// A group ATTACK / DEFEND builds one danger-weighted flow field
+// toward its target, covering every warrior it goes to; their
+// MoveToTarget::OnEnter plans then walk it instead of each
+// running an A* to the same cell. The field settles an area and
+// each A* only a corridor, so it pays off only for squads large
+// for the map (--bench break-even: about 8 warriors on 40x40, 16
+// on 128x128, 32 on 256x256 and 512x512, 64 on 1024x1024).
 // ------------------------------------------------------------
+static void shareSquadField(const Order& o, TeamColor color) {
+    const TeamRoster& roster = (color == TEAM_ORANGE) ? *gRosterOrange : *gRosterBlue;
+    std::vector<Vec2i> squad;
+    for (const Warrior* w : roster.warriors())
+        if (w->isAlive()) squad.push_back(w->getPos());
+    if (!gWorldForStates) return;
+    const size_t side = size_t(gWorldForStates->rows() + gWorldForStates->cols());
+    if (squad.size() * squad.size() < 2 * side) return;
+
+    const SafetyMap* danger = (color == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
+    Pathfinder::shareField(*gWorldForStates, { o.targetRow, o.targetCol }, squad, danger);
+}
+
 void Commander::dispatchOrders(std::vector<Agent*>& team) {
     if (orders.empty()) return;
 
-    int healIndex = -1;
-    for (int i = 0; i < (int)orders.size(); ++i)
-        if (orders[i].type == OrderType::HEAL) {
-            healIndex = i;
-            break;
-        }
+    // Drain every pending order this tick (at most one per role, HEAL first)
+    Order batch[OrderQueue::CAPACITY];
+    int n = orders.popBatch(batch, OrderQueue::CAPACITY);
 
-    Order o;
-    if (healIndex >= 0) {
-        o = orders[healIndex];
-        orders.erase(orders.begin() + healIndex);
-    }
-    else {
-        o = nextOrder();
-    }
+    for (int i = 0; i < n; ++i) {
+        const Order& o = batch[i];
 
-    /*std::printf("Commander (%s) dispatching order: %d.\n",
-        (getTeam() == TEAM_ORANGE ? "Orange" : "Blue"), (int)o.type);*/
+        /*std::printf("Commander (%s) dispatching order: %d.\n",
+            (getTeam() == TEAM_ORANGE ? "Orange" : "Blue"), (int)o.type);*/
 
-    for (auto* a : team) {
-        if (a == this) continue;
-        char role = a->roleLetter()[0];
+        if (o.type == OrderType::ATTACK || o.type == OrderType::DEFEND)
+            shareSquadField(o, getTeam());
 
-        if (o.type == OrderType::HEAL && role != 'M') continue;
-        if (o.type == OrderType::RESUPPLY && role != 'P') continue;
-        if ((o.type == OrderType::ATTACK || o.type == OrderType::DEFEND) && (role == 'M' || role == 'P'))
-            continue;
+        for (auto* a : team) {
+            if (a == this) continue;
+            AgentRole role = a->getRole();
 
-        a->receiveOrder(o);
+            if (o.type == OrderType::HEAL && role != ROLE_MEDIC) continue;
+            if (o.type == OrderType::RESUPPLY && role != ROLE_PROVIDER) continue;
+            if ((o.type == OrderType::ATTACK || o.type == OrderType::DEFEND) && (role == ROLE_MEDIC || role == ROLE_PROVIDER))
+                continue;
+
+            a->receiveOrder(o);
+        }
     }
 }
 
 // ------------------------------------------------------------
 // Support Logic (Heal / Resupply)
 // ------------------------------------------------------------
-void Commander::issueSupportOrders(std::vector<Agent*>& team) {
-    Medic* medic = nullptr;
-    Provider* provider = nullptr;
-
-    for (auto* a : team) {
-        if (!medic && dynamic_cast<Medic*>(a)) medic = (Medic*)a;
-        if (!provider && dynamic_cast<Provider*>(a)) provider = (Provider*)a;
-    }
+void Commander::issueSupportOrders() {
+    const TeamRoster& roster = (getTeam() == TEAM_ORANGE) ? *gRosterOrange : *gRosterBlue;
+    Provider* provider = roster.provider();
 
     // --- Find wounded soldier ---
     //Agent* wounded = nullptr;
@@ -235,9 +228,7 @@ void Commander::issueSupportOrders(std::vector<Agent*>& team) {
     //if (wounded && medic && minHP < 50.0) {
 
     //    // 🧠 Base (medical) storage per team
-    //    Vec2i baseStorage = (getTeam() == TEAM_ORANGE)
-    //        ? Vec2i{ 6, 9 }
-    //    : Vec2i{ MSZ - 7, MSZ - 10 };
+    //    Vec2i baseStorage = gWorldForStates->ammoStorage(getTeam());
 
     //    // 🧮 Distance between wounded soldier and base
     //    int distToBase = std::abs(wounded->row() - baseStorage.r) +
@@ -260,13 +251,11 @@ void Commander::issueSupportOrders(std::vector<Agent*>& team) {
 
    // --- Find soldier low on ammo ---
     Agent* lowAmmo = nullptr;
-    for (auto* a : team) {
-        if (auto* w = dynamic_cast<Warrior*>(a)) {
-            // if low on ammo (2 or less bullets)
-            if (w->isAlive() && w->getBullets() <= 2) {
-                lowAmmo = a;
-                break;
-            }
+    for (auto* w : roster.warriors()) {
+        // if low on ammo (2 or less bullets)
+        if (w->isAlive() && w->getBullets() <= 2) {
+            lowAmmo = w;
+            break;
         }
     }
 
@@ -274,9 +263,7 @@ void Commander::issueSupportOrders(std::vector<Agent*>& team) {
         if (!provider->isMoving()) {
 
             // 🧠 Base position by team
-            Vec2i baseStorage = (getTeam() == TEAM_ORANGE)
-                ? Vec2i{ 6, 9 }
-            : Vec2i{ MSZ - 7, MSZ - 10 };
+            Vec2i baseStorage = gWorldForStates->ammoStorage(getTeam());
 
             // 🧮 Distance between warrior and base
             int distToBase = std::abs(lowAmmo->row() - baseStorage.r) +
@@ -301,18 +288,27 @@ void Commander::issueSupportOrders(std::vector<Agent*>& team) {
 
 // ------------------------------------------------------------
 // Visibility Merging
+// Only sight windows can hold set cells, so the windows merged
+// last time are cleared and the current ones ORed in: the cost
+// follows the team's sight, not the map size.
 // ------------------------------------------------------------
-void Commander::updateCombinedVisibility(const std::vector<Agent*>& team) {
-    if (combinedVis.size() != size_t(MSZ * MSZ))
-        combinedVis.assign(MSZ * MSZ, 0);
-
-    std::fill(combinedVis.begin(), combinedVis.end(), 0);
+void Commander::updateCombinedVisibility(const Map& world, const std::vector<Agent*>& team) {
+    if (!combinedVis.sameShape(world.rows(), world.cols())) {
+        combinedVis.resize(world.rows(), world.cols(), 0);
+        mergedWindows.clear();
+    }
+    for (size_t i = 0; i + 1 < mergedWindows.size(); i += 2) {
+        const Vec2i& lo = mergedWindows[i];
+        const Vec2i& hi = mergedWindows[i + 1];
+        combinedVis.fillRect(lo.r, lo.c, hi.r, hi.c, 0);
+    }
+    mergedWindows.clear();
 
     for (auto* a : team) {
-        const auto& v = a->getVisibility();
-        if (v.size() != size_t(MSZ * MSZ)) continue;
-        for (size_t i = 0; i < v.size(); ++i)
-            combinedVis[i] |= v[i];
+        if (a->visibilityMax().r < 0 || !a->getVisibility().sameShape(world.rows(), world.cols())) continue;
+        a->mergeVisibilityInto(world, combinedVis);
+        mergedWindows.push_back(a->visibilityMin());
+        mergedWindows.push_back(a->visibilityMax());
     }
 }
 
@@ -337,8 +333,7 @@ void Commander::relocateIfInDanger(Map& world, const std::vector<Agent*>& enemie
                 int rr = row() + dr, cc = col() + dc;
                 if (!world.inBounds(rr, cc)) continue;
 
-                CellType ct = world.at(rr, cc);
-                if (ct == ROCK || ct == WATER) continue;
+                if (world.blocksMovement(rr, cc)) continue;
 
                 int val = myDanger->get(rr, cc);
                 if (val >= bestVal) continue;
@@ -350,8 +345,7 @@ void Commander::relocateIfInDanger(Map& world, const std::vector<Agent*>& enemie
                 for (int k = 0; k < 4; ++k) {
                     int nr = rr + adjR[k], nc = cc + adjC[k];
                     if (!world.inBounds(nr, nc)) continue;
-                    CellType nt = world.at(nr, nc);
-                    if (nt == ROCK || nt == TREE) {
+                    if (world.blocksFire(nr, nc)) {
                         hasCover = true;
                         break;
                     }
@@ -375,7 +369,7 @@ void Commander::relocateIfInDanger(Map& world, const std::vector<Agent*>& enemie
         if (ok && !safePath.empty()) {
             setPath(safePath);
             setTarget({ bestR, bestC });
-            setState(new MoveToTarget());
+            setState(MoveToTarget::instance());
             moving = true;
             /*std::printf("🪨 Commander %s moving to cover (%d,%d) [danger %d→%d]\n",
                 getTeam() == TEAM_ORANGE ? "Orange" : "Blue", bestR, bestC, dangerValue, bestVal);*/
@@ -387,6 +381,15 @@ void Commander::relocateIfInDanger(Map& world, const std::vector<Agent*>& enemie
     }
 }
 
+// ------------------------------------------------------------
+// Event scheduling
+// ------------------------------------------------------------
+void Commander::hashState(StateHash& h) const {
+    Agent::hashState(h);
+    orders.hashState(h);
+    h.add(int64_t(thinkFrame));
+}
+
 // ------------------------------------------------------------
 // Rendering
 // ------------------------------------------------------------
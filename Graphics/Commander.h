@@ -1,7 +1,7 @@
 #pragma once
 #include "Agent.h"
 #include "Order.h"
-#include <deque>
+#include "OrderQueue.h"
 #include <vector>
 
 class Map;
@@ -20,26 +20,33 @@ public:
 
     // --- Updates ---
     void update(Map& world) override;
-    void updateCommanderLogic();
+    void updateCommanderLogic();   // strategic update, run when the think timer fires
+    void scheduleThink();          // arms the next think wakeup (THINK_PERIOD from now)
     void dispatchOrders(std::vector<Agent*>& team);
 
     // --- Orders API ---
-    void addOrder(const Order& o);
-    void addPriorityOrder(const Order& o);
-    bool hasPendingHeal() const;
+    void addOrder(const Order& o);   // coalesced; priority follows the order type
+    bool hasPendingHeal() const { return orders.hasPending(OrderType::HEAL); }
     Order nextOrder();
 
+    // --- Event scheduling ---
+    void hashState(StateHash& h) const override;
+
     // --- Combined team visibility management ---
-    void setCombinedVisibility(const std::vector<uint8_t>& vis) { combinedVis = vis; }
-    const std::vector<uint8_t>& getCombinedVisibility() const { return combinedVis; }
+    // Re-merges the sight of 'team' in place (empty: nothing seen)
+    void updateCombinedVisibility(const Map& world, const std::vector<Agent*>& team);
+    const Grid<uint8_t>& getCombinedVisibility() const { return combinedVis; }
 
 private:
     // --- Internal logic helpers ---
-    void updateCombinedVisibility(const std::vector<Agent*>& team);
-    void issueSupportOrders(std::vector<Agent*>& team);
+    void issueSupportOrders();
     void relocateIfInDanger(Map& world, const std::vector<Agent*>& enemies);
 
 private:
-    std::deque<Order> orders;          // command queue
-    std::vector<uint8_t> combinedVis;  // merged visibility from all teammates
+    OrderQueue orders;                 // bounded, coalescing command queue
+    int thinkFrame = 0;                // next strategic update (match frame)
+    Grid<uint8_t> combinedVis;         // merged visibility from all teammates
+    std::vector<Vec2i> mergedWindows;  // (min, max) pairs of the sight windows merged into it
+
+    static const int THINK_PERIOD = 600; // frames between strategic updates
 };
@@ -5,10 +5,9 @@
 // Global constants and enumerations for the simulation
 // ============================================================
 
-// ----- Grid size -----
-#ifndef MSZ
-#define MSZ 40
-#endif
+// ----- Grid size (chosen per match, see Game / --size) -----
+const int DEFAULT_MAP_SIZE = 40;  // rows and columns of the standard map
+const int MIN_MAP_SIZE = 24;      // smallest map the generator and spawn boxes support
 
 // ----- Cell types -----
 enum CellType : int {
@@ -24,6 +23,16 @@ enum CellType : int {
 const int WIN_W = 800;
 const int WIN_H = 800;
 
+// ----- Simulation vs. display rate -----
+const int SIM_STEPS_PER_REDRAW = 1;          // simulation ticks per displayed frame (default)
+const int HEADLESS_MAX_FRAMES = 2000000;     // safety cap for --headless runs
+
+// ----- Pathfinding -----
+const int PATH_NODE_BUDGET = 2048; // A* nodes one agent may expand per tick (see PathSearch)
+const int BIDIRECTIONAL_MIN_DISTANCE = 48; // danger-free queries this far apart (Manhattan) search from both ends
+const int SQUAD_FIELDS = 4; // flow fields kept for group ATTACK / DEFEND targets
+const int COOP_WINDOW = 16; // steps a moving warrior reserves ahead of teammates (WHCA* window)
+
 // ----- Math -----
 const double PI = 3.141592653589793;
 
@@ -33,6 +42,15 @@ enum TeamColor : int {
     TEAM_BLUE = 1
 };
 
+// ----- Agent roles (indexed by TeamRoster) -----
+enum AgentRole : int {
+    ROLE_COMMANDER = 0,
+    ROLE_WARRIOR = 1,
+    ROLE_MEDIC = 2,
+    ROLE_PROVIDER = 3,
+    ROLE_COUNT = 4
+};
+
 // ----- Role letters (for on-screen display) -----
 inline const char* RoleLetterCommander() { return "C"; }
 inline const char* RoleLetterWarrior() { return "W"; }
@@ -0,0 +1,65 @@
+#include "EventScheduler.h"
+#include "Agent.h"
+#include "State.h"
+#include "TimingWheel.h"
+#include <typeinfo>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+
+// ============================================================
+// StateHash
+// ============================================================
+void StateHash::add(double v) {
+    int64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    add(bits);
+}
+
+void StateHash::add(const char* s) {
+    for (; *s; ++s) {
+        h ^= uint8_t(*s);
+        h *= 1099511628211ull;
+    }
+    add(int64_t(0));
+}
+
+void StateHash::add(const Agent* a) {
+    add(int64_t(a ? a->getId() : -1));
+}
+
+void StateHash::add(const State* s) {
+    add(s ? typeid(*s).name() : "");
+}
+
+void StateHash::add(const std::vector<Vec2i>& v) {
+    add(int64_t(v.size()));
+    for (const Vec2i& p : v) add(p);
+}
+
+// ============================================================
+// Per-frame protocol
+// ============================================================
+bool EventScheduler::endFrame(uint64_t stateHash) {
+    ++simulated;
+
+    idle = haveHash && stateHash == lastHash;
+    lastHash = stateHash;
+    haveHash = true;
+    return idle;
+}
+
+int EventScheduler::framesToNextEvent(const TimingWheel& wheel) const {
+    if (!idle) return 0;
+
+    int next = wheel.nextDue();
+    if (next == INT_MAX) return INT_MAX; // nothing armed: the match is frozen for good
+    return std::max(0, next - wheel.now() - 1);
+}
+
+void EventScheduler::reset() {
+    haveHash = false;
+    idle = false;
+    simulated = 0;
+    skipped = 0;
+}
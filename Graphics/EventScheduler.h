@@ -0,0 +1,74 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class Agent;
+class State;
+
+// ============================================================
+// EventScheduler
+// Headless fast-forward over idle stretches of a match.
+//
+// Most frames only wait on timers (MOVE_DELAY, fire cooldown,
+// path re-plan cooldown, commander think period). Timers are
+// absolute deadlines on the match TimingWheel, so after every
+// simulated frame Game fingerprints the match state (the clock
+// itself excluded); if the fingerprint did not change, the frame
+// was idle, and so is every following frame until the next
+// wakeup on the wheel. The scheduler jumps straight to the frame
+// before it, so outcomes match frame-by-frame stepping exactly.
+// ============================================================
+
+// --- 64-bit FNV-1a fingerprint of simulation state ---
+// References are hashed by identity (agent id, state type), never
+// by address, so fingerprints are comparable across runs.
+class StateHash {
+public:
+    void add(int64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= uint64_t(v >> (i * 8)) & 0xff;
+            h *= 1099511628211ull;
+        }
+    }
+    void add(double v);
+    void add(const char* s);
+    void add(const Agent* a);
+    void add(const State* s);
+    // Shifted unsigned: {-1, -1} sentinels are hashed every frame
+    void add(const Vec2i& p) { add(int64_t(uint64_t(uint32_t(p.r)) << 32 | uint32_t(p.c))); }
+    void add(const std::vector<Vec2i>& v);
+
+    uint64_t value() const { return h; }
+
+private:
+    uint64_t h = 14695981039346656037ull;
+};
+
+class TimingWheel;
+
+class EventScheduler {
+public:
+    // --- Per-frame protocol (driven by Game::advance) ---
+    bool endFrame(uint64_t stateHash); // true if the frame was idle
+
+    // Idle frames that can be skipped: everything before the wheel's
+    // next wakeup (0 if the last frame was not idle)
+    int framesToNextEvent(const TimingWheel& wheel) const;
+
+    void recordSkip(int n) { skipped += n; }
+    void reset();
+
+    // --- Statistics ---
+    long long simulatedFrames() const { return simulated; }
+    long long skippedFrames() const { return skipped; }
+
+private:
+    uint64_t lastHash = 0;
+    bool haveHash = false;
+    bool idle = false;
+
+    long long simulated = 0;
+    long long skipped = 0;
+};
@@ -0,0 +1,182 @@
+#include "FirstMoveTable.h"
+#include "Map.h"
+#include "EventScheduler.h"
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// --- 4-neighbourhood (same order as the A* kernels) ---
+static const int STEP_DR[4] = { -1, 1, 0, 0 };
+static const int STEP_DC[4] = { 0, 0, -1, 1 };
+
+static const char FILE_MAGIC[4] = { 'C', 'P', 'D', '1' };
+
+// ============================================================
+// Build
+// ============================================================
+
+// One source row: BFS from 'source', every cell inheriting the first
+// step of the cell it was reached from, then run-length encoded.
+static void buildRow(const Map& world, int source, std::vector<int>& move,
+    std::vector<int>& queue, std::vector<uint32_t>& row)
+{
+    const int R = world.rows(), C = world.cols();
+    std::fill(move.begin(), move.end(), -1);
+    row.clear();
+    if (world.blocksMovement(source / C, source % C)) return;
+
+    int head = 0, tail = 0;
+    move[source] = 4; // the source itself
+    queue[tail++] = source;
+    while (head < tail) {
+        const int cur = queue[head++];
+        const int r = cur / C, c = cur % C;
+        for (int k = 0; k < 4; ++k) {
+            const int nr = r + STEP_DR[k], nc = c + STEP_DC[k];
+            if (nr < 0 || nr >= R || nc < 0 || nc >= C) continue;
+            const int n = nr * C + nc;
+            if (move[n] != -1 || world.blocksMovement(nr, nc)) continue;
+            move[n] = (cur == source) ? k : move[cur];
+            queue[tail++] = n;
+        }
+    }
+
+    int open = -1;
+    for (int t = 0; t < R * C; ++t) {
+        const int m = move[t];
+        if (m < 0 || m > 3 || m == open) continue; // don't care, or same run
+        row.push_back((uint32_t(row.empty() ? 0 : t) << 2) | uint32_t(m));
+        open = m;
+    }
+}
+
+bool FirstMoveTable::build(const Map& world, int threads) {
+    const int N = world.rows() * world.cols();
+    version = 0;
+    if (N > MAX_CELLS) return false;
+
+    threads = std::max(1, threads);
+    std::vector<std::vector<uint32_t>> rows(N);
+    auto worker = [&](int first) {
+        std::vector<int> move(N), queue(N);
+        for (int s = first; s < N; s += threads)
+            buildRow(world, s, move, queue, rows[s]);
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker, i);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+
+    rowStart.assign(N + 1, 0);
+    for (int s = 0; s < N; ++s) rowStart[s + 1] = rowStart[s] + (uint32_t)rows[s].size();
+    runs.clear();
+    runs.reserve(rowStart[N]);
+    for (const auto& r : rows) runs.insert(runs.end(), r.begin(), r.end());
+
+    nRows = world.rows();
+    nCols = world.cols();
+    version = world.terrainVersion();
+    hash = terrainHash(world);
+    return true;
+}
+
+// ============================================================
+// Queries
+// ============================================================
+bool FirstMoveTable::validFor(const Map& world) const {
+    return version != 0 && version == world.terrainVersion();
+}
+
+int FirstMoveTable::firstMove(int source, int target) const {
+    const uint32_t* lo = runs.data() + rowStart[source];
+    const uint32_t* hi = runs.data() + rowStart[source + 1];
+    if (lo == hi) return -1;
+    // last run starting at or before 'target'
+    const uint32_t key = (uint32_t(target) << 2) | 3u;
+    const uint32_t* it = std::upper_bound(lo, hi, key);
+    return int(*(it - 1) & 3u);
+}
+
+bool FirstMoveTable::walk(const Vec2i& start, const Vec2i& goal, std::vector<Vec2i>& outPath) const {
+    outPath.clear();
+    const int target = goal.r * nCols + goal.c;
+    Vec2i cur = start;
+    for (int steps = 0; steps < nRows * nCols; ++steps) {
+        if (cur.r == goal.r && cur.c == goal.c) return true;
+        const int m = firstMove(cur.r * nCols + cur.c, target);
+        if (m < 0) break;
+        cur.r += STEP_DR[m];
+        cur.c += STEP_DC[m];
+        outPath.push_back(cur);
+    }
+    outPath.clear();
+    return false;
+}
+
+// ============================================================
+// File round trip
+// Header: magic, rows, cols, terrain hash, run count; then the row
+// offsets and the runs, in host byte order.
+// ============================================================
+uint64_t FirstMoveTable::terrainHash(const Map& world) {
+    StateHash h;
+    h.add(int64_t(world.rows()));
+    h.add(int64_t(world.cols()));
+    const Bitboard& b = world.moveBlockers();
+    for (int r = 0; r < b.rows(); ++r)
+        for (int k = 0; k < b.wordsPerRow(); ++k)
+            h.add(int64_t(b.row(r)[k]));
+    return h.value();
+}
+
+bool FirstMoveTable::save(const char* path) const {
+    if (version == 0) return false;
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+
+    const int32_t dims[2] = { nRows, nCols };
+    const uint64_t count = runs.size();
+    bool ok = std::fwrite(FILE_MAGIC, 1, 4, f) == 4
+        && std::fwrite(dims, sizeof(dims), 1, f) == 1
+        && std::fwrite(&hash, sizeof(hash), 1, f) == 1
+        && std::fwrite(&count, sizeof(count), 1, f) == 1
+        && std::fwrite(rowStart.data(), sizeof(uint32_t), rowStart.size(), f) == rowStart.size()
+        && std::fwrite(runs.data(), sizeof(uint32_t), runs.size(), f) == runs.size();
+    ok = (std::fclose(f) == 0) && ok;
+    return ok;
+}
+
+bool FirstMoveTable::load(const char* path, const Map& world) {
+    version = 0;
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    char magic[4];
+    int32_t dims[2];
+    uint64_t fileHash = 0, count = 0;
+    bool ok = std::fread(magic, 1, 4, f) == 4 && std::memcmp(magic, FILE_MAGIC, 4) == 0
+        && std::fread(dims, sizeof(dims), 1, f) == 1
+        && dims[0] == world.rows() && dims[1] == world.cols()
+        && std::fread(&fileHash, sizeof(fileHash), 1, f) == 1
+        && fileHash == terrainHash(world)
+        && std::fread(&count, sizeof(count), 1, f) == 1
+        && count <= uint64_t(dims[0]) * dims[1] * dims[0] * dims[1];
+    if (ok) {
+        rowStart.resize(size_t(dims[0]) * dims[1] + 1);
+        runs.resize(size_t(count));
+        ok = std::fread(rowStart.data(), sizeof(uint32_t), rowStart.size(), f) == rowStart.size()
+            && std::fread(runs.data(), sizeof(uint32_t), runs.size(), f) == runs.size()
+            && rowStart.front() == 0 && rowStart.back() == count
+            && std::is_sorted(rowStart.begin(), rowStart.end());
+    }
+    std::fclose(f);
+    if (!ok) return false;
+
+    nRows = dims[0];
+    nCols = dims[1];
+    hash = fileHash;
+    version = world.terrainVersion();
+    return true;
+}
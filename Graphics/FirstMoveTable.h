@@ -0,0 +1,61 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Forward declaration
+class Map;
+
+// ============================================================
+// FirstMoveTable
+// Compressed all-pairs first moves (CPD) for small static maps:
+// for every source cell, the first step of a shortest (unit-cost)
+// path toward every target cell. A source's row lists targets in
+// row-major order as runs of the same move; blocked and
+// unreachable targets are "don't care" and join whichever run is
+// open, so neighbouring targets collapse into a few runs. A query
+// walks the table one step at a time (binary search per step),
+// with no search at all.
+//
+// Rows are built by one BFS per source, spread over all hardware
+// threads. The table is tied to the terrain it was built on
+// (Map::terrainVersion in memory, a hash of the movement blockers
+// on disk) and can be saved and reloaded.
+// ============================================================
+class FirstMoveTable {
+public:
+    static const int MAX_CELLS = 128 * 128; // larger maps are not tabled
+
+    // Builds every row for the current terrain (false if the map is too large)
+    bool build(const Map& world, int threads);
+
+    // File round trip; load() fails unless the file matches this terrain
+    bool save(const char* path) const;
+    bool load(const char* path, const Map& world);
+
+    // True if the table describes the map's current terrain
+    bool validFor(const Map& world) const;
+
+    // Cells after 'start' up to 'goal' (both passable and connected);
+    // false if the walk does not arrive
+    bool walk(const Vec2i& start, const Vec2i& goal, std::vector<Vec2i>& outPath) const;
+
+    // --- Statistics ---
+    size_t runCount() const { return runs.size(); }
+    size_t bytes() const { return (runs.size() + rowStart.size()) * sizeof(uint32_t); }
+
+    // Movement-blocker fingerprint the file name and header use
+    static uint64_t terrainHash(const Map& world);
+
+private:
+    // run = (first target index << 2) | move (index into the 4 step directions)
+    std::vector<uint32_t> runs;
+    std::vector<uint32_t> rowStart; // runs of source s: [rowStart[s], rowStart[s + 1])
+    int nRows = 0;
+    int nCols = 0;
+    uint32_t version = 0;           // Map::terrainVersion (0: none)
+    uint64_t hash = 0;
+
+    int firstMove(int source, int target) const;
+};
@@ -0,0 +1,131 @@
+#include "FlowField.h"
+#include "Map.h"
+#include "SafetyMap.h"
+#include <algorithm>
+
+// --- 4-neighbourhood (same order as the A* kernels) ---
+static const int STEP_DR[4] = { -1, 1, 0, 0 };
+static const int STEP_DC[4] = { 0, 0, -1, 1 };
+
+// Costs of cells reached by the current build, stamped so nothing
+// map-sized is cleared per build (one build runs at a time)
+static std::vector<int> gCost;
+static std::vector<uint8_t> gStep;     // step of the cheapest way found so far
+static std::vector<uint32_t> gReached;
+static uint32_t gStamp = 0;
+
+// Step costs run 1..MAX_STEP_COST, so the open cells fit a ring of
+// that many + 1 buckets indexed by cost (Dial's algorithm): no heap,
+// and cells come out in cost order, ties in the order they came in.
+static const int MAX_STEP_COST = 11;
+static const int BUCKETS = MAX_STEP_COST + 1;
+static std::vector<int> gBuckets[BUCKETS];
+
+// ============================================================
+// Build
+// The search runs backwards: the cost of a cell is what the walk
+// from it pays, i.e. the step costs of every cell after it, goal
+// included. A cell reached from q steps to q; cells that block
+// movement are settled (an agent may stand on one) but not
+// expanded.
+// ============================================================
+bool FlowField::build(const Map& world, const Vec2i& g, const std::vector<Vec2i>& starts,
+    const SafetyMap* danger)
+{
+    nRows = world.rows();
+    nCols = world.cols();
+    goal = g;
+    costs = danger;
+    terrain = world.terrainVersion();
+    dangerVersion = danger ? danger->version() : 0;
+    settledCells = 0;
+    next.assign(size_t(nRows) * nCols, 0);
+
+    std::vector<int> pending; // start cells not settled yet
+    for (const Vec2i& s : starts)
+        if (world.connected(s, g)) pending.push_back(s.r * nCols + s.c);
+    if (pending.empty()) return false;
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+    size_t left = pending.size();
+
+    if (gCost.size() != next.size() || gStamp == UINT32_MAX) {
+        gCost.assign(next.size(), 0);
+        gStep.assign(next.size(), 0);
+        gReached.assign(next.size(), 0);
+        gStamp = 0;
+    }
+    ++gStamp;
+
+    auto stepCost = [danger](int r, int c) {
+        return danger ? 1 + std::max(0, std::min(10, danger->get(r, c) / 10)) : 1;
+    };
+
+    for (std::vector<int>& b : gBuckets) b.clear();
+    const int goalKey = g.r * nCols + g.c;
+    gCost[goalKey] = 0;
+    gReached[goalKey] = gStamp;
+    gStep[goalKey] = GOAL_CELL;
+    gBuckets[0].push_back(goalKey);
+    size_t open = 1;
+
+    for (int cost = 0; open > 0 && left > 0; ++cost) {
+        std::vector<int>& bucket = gBuckets[cost % BUCKETS];
+        for (size_t i = 0; i < bucket.size() && left > 0; ++i) {
+            const int k = bucket[i];
+            if (gCost[k] != cost || next[k] != 0) continue; // improved since, or settled
+            next[k] = gStep[k];
+            ++settledCells;
+            if (std::binary_search(pending.begin(), pending.end(), k)) --left;
+
+            const int r = k / nCols, c = k % nCols;
+            if (k != goalKey && world.blocksMovement(r, c)) continue;
+            const int reach = cost + stepCost(r, c); // a step into this cell
+
+            for (int d = 0; d < 4; ++d) {
+                const int pr = r + STEP_DR[d], pc = c + STEP_DC[d];
+                if (!world.inBounds(pr, pc)) continue;
+                const int p = pr * nCols + pc;
+                if (gReached[p] == gStamp && gCost[p] <= reach) continue;
+                gReached[p] = gStamp;
+                gCost[p] = reach;
+                gStep[p] = uint8_t((d ^ 1) + 1); // back toward this cell
+                gBuckets[reach % BUCKETS].push_back(p);
+                ++open;
+            }
+        }
+        open -= bucket.size();
+        bucket.clear();
+    }
+    return true;
+}
+
+// ============================================================
+// Queries
+// ============================================================
+bool FlowField::matches(const Map& world, const Vec2i& g, const SafetyMap* danger) const {
+    return settledCells > 0 && keyedOn(g, danger)
+        && terrain == world.terrainVersion()
+        && dangerVersion == (danger ? danger->version() : 0u);
+}
+
+bool FlowField::covers(const Vec2i& p) const {
+    return p.r >= 0 && p.r < nRows && p.c >= 0 && p.c < nCols
+        && next[size_t(p.r) * nCols + p.c] != 0;
+}
+
+bool FlowField::walk(const Vec2i& from, std::vector<Vec2i>& out) const {
+    out.clear();
+    if (from.r < 0 || from.r >= nRows || from.c < 0 || from.c >= nCols) return false;
+
+    Vec2i p = from;
+    for (long long n = 0; n <= settledCells; ++n) {
+        const uint8_t m = next[size_t(p.r) * nCols + p.c];
+        if (m == GOAL_CELL) return true;
+        if (m == 0) break;
+        p = { p.r + STEP_DR[m - 1], p.c + STEP_DC[m - 1] };
+        out.push_back(p);
+    }
+    out.clear();
+    return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <cstdint>
+
+// Forward declarations
+class Map;
+class SafetyMap;
+
+// ============================================================
+// FlowField
+// Next steps toward one goal under the A* step costs (danger
+// included), shared by every agent sent there. It is built by a
+// Dijkstra outward from the goal that stops once all the cells it
+// was asked to cover are settled. Each settled cell keeps the
+// direction of its step along a cheapest path, so a route from any
+// of them is a walk, however many agents take it.
+//
+// One byte per map cell. The field is tied to the goal and to the
+// terrain and danger versions it was costed under.
+// ============================================================
+class FlowField {
+public:
+    // Grows the field from 'goal' until every cell of 'starts' connected
+    // to it is settled. False (and an empty field) if none is.
+    bool build(const Map& world, const Vec2i& goal, const std::vector<Vec2i>& starts,
+        const SafetyMap* danger);
+
+    // True if built for 'goal' under the map's terrain and 'danger' as they are now
+    bool matches(const Map& world, const Vec2i& goal, const SafetyMap* danger) const;
+
+    // True if 'p' is settled (a walk from it arrives)
+    bool covers(const Vec2i& p) const;
+
+    // Cells after 'from' up to the goal; false if 'from' is not settled
+    bool walk(const Vec2i& from, std::vector<Vec2i>& out) const;
+
+    // Built toward 'g' with the costs of 'danger' (whatever their version)
+    bool keyedOn(const Vec2i& g, const SafetyMap* danger) const {
+        return goal.r == g.r && goal.c == g.c && costs == danger;
+    }
+    bool empty() const { return settledCells == 0; }
+    long long settled() const { return settledCells; }
+
+private:
+    std::vector<uint8_t> next; // 0: not settled, 1..4: step direction + 1, GOAL_CELL: the goal
+    int nRows = 0;
+    int nCols = 0;
+    Vec2i goal{ -1, -1 };
+    const SafetyMap* costs = nullptr; // danger map the field was costed on
+    uint32_t terrain = 0;       // Map::terrainVersion
+    uint32_t dangerVersion = 0; // SafetyMap::version (0: danger-free)
+    long long settledCells = 0;
+
+    static const uint8_t GOAL_CELL = 5;
+};
@@ -7,8 +7,9 @@
 #include "Warrior.h"
 #include "Medic.h"
 #include "Provider.h"
+#include "MoveToTarget.h"
 #include "SafetyMap.h"
-#include "Grenade.h"
+#include "AllocCounter.h"
 #include <ctime>
 #include <cstdlib>
 #include <algorithm>
@@ -25,6 +26,12 @@ SafetyMap* gDangerOrange = nullptr;
 SafetyMap* gDangerBlue = nullptr;
 std::vector<Agent*> gTeamOrange;
 std::vector<Agent*> gTeamBlue;
+TeamRoster* gRosterOrange = nullptr;
+TeamRoster* gRosterBlue = nullptr;
+SpatialIndex* gSpatialIndex = nullptr;
+ProjectileSystem* gProjectiles = nullptr;
+TimingWheel* gTimingWheel = nullptr;
+unsigned long gRandDraws = 0;
 bool gMedicBusy = false;
 bool gProviderBusy = false;
 
@@ -32,14 +39,9 @@ bool gProviderBusy = false;
 // ------------------------------------------------------------
 // Commander auto-heal helper
 // ------------------------------------------------------------
-static void commanderAutoHeal(std::vector<Agent*>& team) {
-    Commander* cmd = nullptr;
-    Medic* med = nullptr;
-
-    for (auto* a : team) {
-        if (!cmd)  cmd = dynamic_cast<Commander*>(a);
-        if (!med)  med = dynamic_cast<Medic*>(a);
-    }
+static void commanderAutoHeal(const TeamRoster& roster) {
+    Commander* cmd = roster.commander();
+    Medic* med = roster.medic();
     if (!cmd || !med) return;
 
     // Skip if commander already has heal queued or medic is busy
@@ -48,7 +50,7 @@ static void commanderAutoHeal(std::vector<Agent*>& team) {
 
     // Find dead teammate
     Agent* bestDown = nullptr;
-    for (auto* a : team) {
+    for (auto* a : roster.all()) {
         if (a == med) continue;
         if (a->getHP() <= 0.0) { bestDown = a; break; }
     }
@@ -56,7 +58,7 @@ static void commanderAutoHeal(std::vector<Agent*>& team) {
     if (!bestDown) return;
 
     const Vec2i& p = bestDown->getPos();
-    cmd->addPriorityOrder(Order(OrderType::HEAL, p.r, p.c));
+    cmd->addOrder(Order(OrderType::HEAL, p.r, p.c));
    /* std::printf("Commander auto-HEAL -> (%d,%d) [HP=%.0f].\n", p.r, p.c, bestDown->getHP());*/
 }
 
@@ -87,8 +89,7 @@ static void ensureClearRing(Map& world, const Vec2i& center, int radius = 2) {
             int cc = center.c + dc;
             if (!world.inBounds(rr, cc)) continue;
 
-            CellType ct = world.at(rr, cc);
-            if (ct == ROCK || ct == WATER)
+            if (world.blocksMovement(rr, cc))
                 world.set(rr, cc, EMPTY);
         }
 }
@@ -96,59 +97,53 @@ static void ensureClearRing(Map& world, const Vec2i& center, int radius = 2) {
 // ------------------------------------------------------------
 // Constructor
 // ------------------------------------------------------------
-Game::Game() : frame(0) {}
+Game::Game(int rows, int cols) : world(rows, cols) {}
 
 // ------------------------------------------------------------
 // Visibility merging for commander
 // ------------------------------------------------------------
-static void updateCommanderVisibilityForTeam(const std::vector<Agent*>& team) {
-    Commander* cmd = nullptr;
-    for (auto* a : team) {
-        cmd = dynamic_cast<Commander*>(a);
-        if (cmd) break;
-    }
-
+static void updateCommanderVisibilityForTeam(const TeamRoster& roster, const Map& world) {
+    Commander* cmd = roster.commander();
     if (!cmd) return;
 
-    if (cmd->isAlive()) {
-        std::vector<uint8_t> unionVis(MSZ * MSZ, 0);
-        for (auto* a : team) {
-            const auto& v = a->getVisibility();
-            if (v.size() != size_t(MSZ * MSZ)) continue;
-            for (size_t i = 0; i < v.size(); ++i)
-                unionVis[i] |= v[i];
-        }
-        cmd->setCombinedVisibility(unionVis);
-    }
-    else {
-        std::vector<uint8_t> emptyVis(MSZ * MSZ, 0);
-        cmd->setCombinedVisibility(emptyVis);
-    }
+    static const std::vector<Agent*> nobody;
+    cmd->updateCombinedVisibility(world, cmd->isAlive() ? roster.all() : nobody);
 }
 
 // ------------------------------------------------------------
 // Initialization
 // ------------------------------------------------------------
 void Game::init() {
-    srand((unsigned)time(nullptr));
+    init((unsigned)time(nullptr));
+}
+
+void Game::init(unsigned seed) {
+    srand(seed);
+    wheel.reset();
+    gTimingWheel = &wheel;
     world.initStructured();
 
     // Define storages for both teams
-    medStorageOrange = { 6, 6 };
-    ammoStorageOrange = { 6, 9 };
-    medStorageBlue = { MSZ - 7, MSZ - 7 };
-    ammoStorageBlue = { MSZ - 7, MSZ - 10 };
+    medStorageOrange = world.medStorage(TEAM_ORANGE);
+    ammoStorageOrange = world.ammoStorage(TEAM_ORANGE);
+    medStorageBlue = world.medStorage(TEAM_BLUE);
+    ammoStorageBlue = world.ammoStorage(TEAM_BLUE);
     gWorldForStates = &world;
 
     // Connect global danger maps
     gDangerOrange = &dangerOrange;
     gDangerBlue = &dangerBlue;
 
+    // Danger fields match the map
+    dangerOrange.resize(world.rows(), world.cols());
+    dangerBlue.resize(world.rows(), world.cols());
+
     // Spawn regions
-    int Or_r0 = 3, Or_r1 = MSZ / 3;
-    int Or_c0 = 3, Or_c1 = MSZ / 3;
-    int Bl_r0 = MSZ - MSZ / 3, Bl_r1 = MSZ - 3;
-    int Bl_c0 = MSZ - MSZ / 3, Bl_c1 = MSZ - 3;
+    const int R = world.rows(), C = world.cols();
+    int Or_r0 = 3, Or_r1 = R / 3;
+    int Or_c0 = 3, Or_c1 = C / 3;
+    int Bl_r0 = R - R / 3, Bl_r1 = R - 3;
+    int Bl_c0 = C - C / 3, Bl_c1 = C - 3;
 
     std::vector<Vec2i> takenOrange, takenBlue;
 
@@ -200,85 +195,141 @@ void Game::init() {
         teamBlue.push_back(new Warrior(TEAM_BLUE, pW2.r, pW2.c));
     }
 
+    // --- Spawn ids (stable identity for state fingerprints) ---
+    int nextId = 0;
+    for (auto* a : teamOrange) a->setId(nextId++);
+    for (auto* a : teamBlue)   a->setId(nextId++);
+    wokenAt.assign(nextId, -1);
+    haveFrameHash = false;
+    quiet = false;
+
+    // --- Role index (built once; kept current on death / revive) ---
+    for (auto* a : teamOrange) rosterOrange.add(a);
+    for (auto* a : teamBlue)   rosterBlue.add(a);
+
+    // --- Spatial index (insertion order = team order, used as tie-break) ---
+    spatial.reset(world.rows(), world.cols());
+    for (auto* a : teamOrange) spatial.insert(a);
+    for (auto* a : teamBlue)   spatial.insert(a);
+
     // --- Initial orders ---
-    for (auto* a : teamOrange)
-        if (auto* cmd = dynamic_cast<Commander*>(a))
-            cmd->addOrder(Order(OrderType::ATTACK, MSZ - 10, MSZ - 10));
+    Vec2i openingOrange = world.rallyCorner(TEAM_BLUE, 10);
+    Vec2i openingBlue = world.rallyCorner(TEAM_ORANGE, 5);
+    for (auto* cmd : rosterOrange.commanders())
+        cmd->addOrder(Order(OrderType::ATTACK, openingOrange.r, openingOrange.c));
 
-    for (auto* a : teamBlue)
-        if (auto* cmd = dynamic_cast<Commander*>(a))
-            cmd->addOrder(Order(OrderType::ATTACK, 5, 5));
+    for (auto* cmd : rosterBlue.commanders())
+        cmd->addOrder(Order(OrderType::ATTACK, openingBlue.r, openingBlue.c));
+
+    // --- Commander think cycle ---
+    for (auto* cmd : rosterOrange.commanders()) cmd->scheduleThink();
+    for (auto* cmd : rosterBlue.commanders())   cmd->scheduleThink();
 
     gTeamOrange = teamOrange;
     gTeamBlue = teamBlue;
+    gRosterOrange = &rosterOrange;
+    gRosterBlue = &rosterBlue;
+    gSpatialIndex = &spatial;
+    gProjectiles = &projectiles;
+}
+
+// ------------------------------------------------------------
+// Quiet frames
+// When the last frame changed nothing, this one starts from the
+// same state, so an agent none of whose timers fired would repeat
+// what it did then: nothing. Only the woken agents are visited,
+// until one of them (or a commander think, or an order) changes
+// the state; from there on the frame runs for everyone, as it
+// would have. Live projectiles move without being hashed, so no
+// frame with any in flight is quiet.
+// ------------------------------------------------------------
+bool Game::visits(const Agent* a) {
+    if (!quiet || wokenAt[a->getId()] == wheel.now()) return true;
+    ++agentsSkipped;
+    return false;
+}
+
+void Game::visited() {
+    ++agentVisits;
+    checkQuiet();
+}
+
+void Game::checkQuiet() {
+    if (quiet && stateHash() != frameHash) quiet = false;
 }
 
 // ------------------------------------------------------------
 // Update logic (main game loop)
 // ------------------------------------------------------------
 void Game::update() {
-    
-    ++frame;
+    AllocCounter::Snapshot allocStart = AllocCounter::now();
+
+    // 0. Advance the match clock; collect the timers that fire this frame
+    fired.clear();
+    wheel.tick(fired);
+    for (const Wakeup& w : fired)
+        wokenAt[w.agent->getId()] = wheel.now();
 
     // 1. Compute danger maps
     dangerOrange.compute(teamBlue);
     dangerBlue.compute(teamOrange);
 
     // 2. Auto-heal if needed
-    commanderAutoHeal(teamOrange);
-    commanderAutoHeal(teamBlue);
-
-    // 3. Commander logic
-    Commander* orangeCmd = nullptr;
-    Commander* blueCmd = nullptr;
-    bool orangeAlive = false;
-    bool blueAlive = false;
-
-    for (auto* a : teamOrange)
-        if (auto* cmd = dynamic_cast<Commander*>(a)) { orangeCmd = cmd; orangeAlive = cmd->isAlive(); }
-
-    for (auto* a : teamBlue)
-        if (auto* cmd = dynamic_cast<Commander*>(a)) { blueCmd = cmd; blueAlive = cmd->isAlive(); }
+    commanderAutoHeal(rosterOrange);
+    commanderAutoHeal(rosterBlue);
+
+    // 3. Commander logic (only commanders whose think timer fired)
+    for (const Wakeup& w : fired) {
+        if (w.kind != TIMER_THINK) continue;
+        auto* cmd = static_cast<Commander*>(w.agent);
+        cmd->scheduleThink();
+        if (cmd->isAlive()) cmd->updateCommanderLogic();
+    }
 
-    if (orangeAlive) orangeCmd->updateCommanderLogic();
-    if (blueAlive)   blueCmd->updateCommanderLogic();
+    Commander* orangeCmd = rosterOrange.commander();
+    Commander* blueCmd = rosterBlue.commander();
+    bool orangeAlive = orangeCmd && orangeCmd->isAlive();
+    bool blueAlive = blueCmd && blueCmd->isAlive();
 
     // Warriors act independently if commander is dead
+    checkQuiet();
     if (!orangeAlive)
-        for (auto* a : teamOrange)
-            if (auto* w = dynamic_cast<Warrior*>(a))
-                w->tryAttackNearbyEnemies(gTeamBlue);
+        for (auto* w : rosterOrange.warriors())
+            if (visits(w)) { w->tryAttackNearbyEnemies(TEAM_BLUE); visited(); }
 
     if (!blueAlive)
-        for (auto* a : teamBlue)
-            if (auto* w = dynamic_cast<Warrior*>(a))
-                w->tryAttackNearbyEnemies(gTeamOrange);
+        for (auto* w : rosterBlue.warriors())
+            if (visits(w)) { w->tryAttackNearbyEnemies(TEAM_ORANGE); visited(); }
 
     // 4. Dispatch orders
-    for (auto* a : teamOrange)
-        if (auto* cmd = dynamic_cast<Commander*>(a))
-            cmd->dispatchOrders(teamOrange);
+    for (auto* cmd : rosterOrange.commanders())
+        cmd->dispatchOrders(teamOrange);
+
+    for (auto* cmd : rosterBlue.commanders())
+        cmd->dispatchOrders(teamBlue);
 
-    for (auto* a : teamBlue)
-        if (auto* cmd = dynamic_cast<Commander*>(a))
-            cmd->dispatchOrders(teamBlue);
+    // 4b. Cooperative windows: warriors reserve their next steps team by team
+    MoveToTarget::planWindows(teamOrange, reservationsOrange);
+    MoveToTarget::planWindows(teamBlue, reservationsBlue);
 
-    // 5. Update agents
-    for (auto* a : teamOrange) a->update(world);
-    for (auto* a : teamBlue)   a->update(world);
+    // 5. Update agents (on a quiet frame, those whose timers fired)
+    checkQuiet();
+    for (auto* a : teamOrange) if (visits(a)) { a->update(world); visited(); }
+    for (auto* a : teamBlue)   if (visits(a)) { a->update(world); visited(); }
 
     // 6. Warrior combat
-    for (auto* a : teamOrange)
-        if (auto* w = dynamic_cast<Warrior*>(a))
-            w->tryAttackNearbyEnemies(teamBlue);
+    for (auto* w : rosterOrange.warriors())
+        if (visits(w)) { w->tryAttackNearbyEnemies(TEAM_BLUE); visited(); }
 
-    for (auto* a : teamBlue)
-        if (auto* w = dynamic_cast<Warrior*>(a))
-            w->tryAttackNearbyEnemies(teamOrange);
+    for (auto* w : rosterBlue.warriors())
+        if (visits(w)) { w->tryAttackNearbyEnemies(TEAM_ORANGE); visited(); }
+
+    // 6b. Advance bullets and grenade fragments (simulation rate, not display rate)
+    projectiles.update(world);
 
     // 7. Check victory condition
-    bool allOrangeDead = std::all_of(teamOrange.begin(), teamOrange.end(), [](Agent* a) { return !a->isAlive(); });
-    bool allBlueDead = std::all_of(teamBlue.begin(), teamBlue.end(), [](Agent* a) { return !a->isAlive(); });
+    bool allOrangeDead = rosterOrange.aliveTotal() == 0;
+    bool allBlueDead = rosterBlue.aliveTotal() == 0;
 
     if (!gameOver && (allOrangeDead || allBlueDead)) {
         gameOver = true;
@@ -295,8 +346,45 @@ void Game::update() {
     }
 
     // 8. Update combined visibility
-    updateCommanderVisibilityForTeam(teamOrange);
-    updateCommanderVisibilityForTeam(teamBlue);
+    updateCommanderVisibilityForTeam(rosterOrange, world);
+    updateCommanderVisibilityForTeam(rosterBlue, world);
+
+    // 9. The next frame is quiet if this one changed nothing
+    const uint64_t h = stateHash();
+    quiet = haveFrameHash && h == frameHash && projectiles.size() == 0;
+    frameHash = h;
+    haveFrameHash = true;
+
+    allocationsLastUpdate = AllocCounter::since(allocStart).allocations;
+    allocationsMax = std::max(allocationsMax, allocationsLastUpdate);
+    allocationsTotal += allocationsLastUpdate;
+    ++updates;
+}
+
+// ------------------------------------------------------------
+// Headless fast-forward
+// ------------------------------------------------------------
+uint64_t Game::stateHash() const {
+    StateHash h;
+    h.add(int64_t(gameOver));
+    h.add(int64_t(gRandDraws));
+    h.add(int64_t(projectiles.size()));
+    for (auto* a : teamOrange) a->hashState(h);
+    for (auto* a : teamBlue)   a->hashState(h);
+    return h.value();
+}
+
+int Game::advance(int maxSkip) {
+    update();
+    bool idle = scheduler.endFrame(frameHash);
+
+    // Live projectiles move every frame, so nothing is skipped until they retire
+    if (!idle || gameOver || projectiles.size() > 0) return 1;
+
+    int n = std::max(0, std::min(scheduler.framesToNextEvent(wheel), maxSkip));
+    wheel.skipTo(wheel.now() + n);
+    scheduler.recordSkip(n);
+    return 1 + n;
 }
 
 // ------------------------------------------------------------
@@ -308,9 +396,8 @@ void Game::render() const {
     for (auto* a : teamOrange) a->render();
     for (auto* a : teamBlue)   a->render();
 
-    // Draw active bullets and grenades
-    Warrior::updateBulletsAndDraw(const_cast<Map&>(world));
-    Warrior::updateGrenadesAndDraw(const_cast<Map&>(world));
+    // Draw active bullets and grenade fragments (read-only; advanced in update)
+    projectiles.draw();
 
     // Display winner banner
     if (gameOver) {
@@ -321,8 +408,8 @@ void Game::render() const {
         for (char c : winningTeam)
             textWidth += glutBitmapWidth(font, c);
 
-        double centerX = MSZ / 2.0;
-        double centerY = MSZ / 2.0;
+        double centerX = world.cols() / 2.0;
+        double centerY = world.rows() / 2.0;
 
         
         double paddingX = 1.0;   
@@ -2,6 +2,12 @@
 #include "Definitions.h"
 #include "Map.h"
 #include "SafetyMap.h"
+#include "TeamRoster.h"
+#include "SpatialIndex.h"
+#include "ProjectileSystem.h"
+#include "EventScheduler.h"
+#include "TimingWheel.h"
+#include "Reservations.h"
 #include <vector>
 #include <string>
 
@@ -15,16 +21,40 @@ class Game {
 private:
     // --- Map and simulation ---
     Map world;
-    int frame = 0;
+    TimingWheel wheel;          // match clock; all timers are deadlines on it
+    std::vector<Wakeup> fired;  // wakeups due this tick (scratch)
 
     // --- Team agents ---
     std::vector<Agent*> teamOrange;
     std::vector<Agent*> teamBlue;
 
+    // --- Role-indexed rosters ---
+    TeamRoster rosterOrange;
+    TeamRoster rosterBlue;
+
+    // --- Agent positions (bucketed) ---
+    SpatialIndex spatial;
+
+    // --- Bullets and grenade fragments ---
+    ProjectileSystem projectiles;
+
+    // --- Headless fast-forward ---
+    EventScheduler scheduler;
+
+    // --- Quiet frames (only woken agents are visited) ---
+    std::vector<int> wokenAt;   // frame of each agent's last fired wakeup, by agent id
+    uint64_t frameHash = 0;     // stateHash() at the end of the last update()
+    bool haveFrameHash = false;
+    bool quiet = false;         // nothing has changed since the last frame, which changed nothing
+
     // --- Safety maps ---
     SafetyMap dangerOrange; // danger from blue team
     SafetyMap dangerBlue;   // danger from orange team
 
+    // --- Space-time reservations of moving warriors (WHCA*) ---
+    ReservationTable reservationsOrange;
+    ReservationTable reservationsBlue;
+
     // --- Storage positions ---
     Vec2i medStorageOrange;
     Vec2i ammoStorageOrange;
@@ -38,11 +68,40 @@ public:
 
 public:
     // --- Core methods ---
-    Game();
-    void init();    // setup map, agents, and initial states
-    void update();  // per-frame game logic
-    void render() const; // render all entities
+    Game(int rows = DEFAULT_MAP_SIZE, int cols = DEFAULT_MAP_SIZE);
+    void init();    // setup map, agents, and initial states (time-based seed)
+    void init(unsigned seed);
+    void update();  // one simulation tick (all game logic, including projectiles)
+
+    // Headless: one tick, then jump over the idle frames that follow it
+    // (at most maxSkip). Returns the number of frames advanced.
+    int advance(int maxSkip);
+    void render() const; // draw the current state; never advances the simulation
 
     // --- Accessor ---
     Map& getMap() { return world; }
+
+    int getFrame() const { return wheel.now(); }
+
+    // --- Diagnostics ---
+    size_t getAllocationsLastUpdate() const { return allocationsLastUpdate; }
+    size_t getAllocationsMax() const { return allocationsMax; }       // most made by one update()
+    size_t getAllocationsTotal() const { return allocationsTotal; }   // made by all update() calls
+    size_t getUpdateCount() const { return updates; }
+    size_t getAgentVisits() const { return agentVisits; }             // agent updates / combat checks run
+    size_t getAgentsSkipped() const { return agentsSkipped; }         // the same, left out on quiet frames
+    const EventScheduler& getScheduler() const { return scheduler; }
+    uint64_t stateHash() const; // fingerprint of everything but the clock
+
+private:
+    size_t allocationsLastUpdate = 0; // heap allocations made by the last update()
+    size_t allocationsMax = 0;
+    size_t allocationsTotal = 0;
+    size_t updates = 0;
+    size_t agentVisits = 0;
+    size_t agentsSkipped = 0;
+
+    bool visits(const Agent* a);
+    void visited();
+    void checkQuiet();
 };
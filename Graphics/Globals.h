@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <cstdlib>
 
 // ============================================================
 // Globals.h
@@ -10,6 +11,10 @@
 class Map;
 class SafetyMap;
 class Agent;
+class TeamRoster;
+class SpatialIndex;
+class ProjectileSystem;
+class TimingWheel;
 
 // --- Global map reference (for FSM pathfinding) ---
 extern Map* gWorldForStates;
@@ -21,3 +26,21 @@ extern SafetyMap* gDangerBlue;
 // --- Team vectors (shared across the simulation) ---
 extern std::vector<Agent*> gTeamOrange;
 extern std::vector<Agent*> gTeamBlue;
+
+// --- Team rosters (role-indexed views of the team vectors) ---
+extern TeamRoster* gRosterOrange;
+extern TeamRoster* gRosterBlue;
+
+// --- Spatial hash of all agents (neighbour / range queries) ---
+extern SpatialIndex* gSpatialIndex;
+
+// --- Pooled bullets / grenade fragments ---
+extern ProjectileSystem* gProjectiles;
+
+// --- Match clock and timer wakeups ---
+extern TimingWheel* gTimingWheel;
+
+// --- Counted rand(): every draw during a frame marks it as active
+//     for the headless fast-forward (see EventScheduler) ---
+extern unsigned long gRandDraws;
+inline int simRand() { ++gRandDraws; return std::rand(); }
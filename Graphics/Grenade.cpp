@@ -1 +0,0 @@
-#include "Grenade.h"
@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+
+// ============================================================
+// Grid.h
+// Runtime-sized 2D grid used for the terrain, the danger fields,
+// visibility maps and path-finding scratch.
+//
+// Wide grids are tiled: the map is cut into 8x8 blocks stored
+// one after another, each block row-major inside. A step up or
+// down a row stays inside the block (same or next cache line)
+// instead of jumping a whole map row, which is what LOS rays,
+// the danger kernel and A* neighbour expansion do. Narrower
+// grids stay row-major: below TILED_MIN_COLS the hardware
+// prefetcher hides the row stride and the plain index is cheaper
+// (see battle --bench). The layout depends only on the width, so
+// all grids of one map share it. Storage starts on a
+// cache-line boundary; tiled grids are padded to whole tiles.
+// Use operator()(r, c), gridIndex() or the forEach visitors;
+// never assume row-major data().
+// ============================================================
+
+// --- Tile geometry ---
+const int TILE_BITS = 3;
+const int TILE = 1 << TILE_BITS;          // 8x8 cells per tile
+const int TILE_MASK = TILE - 1;
+const int TILE_CELLS = TILE * TILE;
+
+constexpr int tilesFor(int cells) { return (cells + TILE - 1) >> TILE_BITS; }
+
+const int TILED_MIN_COLS = 4096; // narrower grids are row-major
+
+// Tiles per row of a grid 'cols' wide, 0 for a row-major grid
+constexpr int tilesPerRowFor(int cols) { return cols >= TILED_MIN_COLS ? tilesFor(cols) : 0; }
+
+// Storage offset of (r, c) in a grid 'tilesPerRow' tiles wide
+constexpr int tiledIndex(int r, int c, int tilesPerRow) {
+    return (((r >> TILE_BITS) * tilesPerRow + (c >> TILE_BITS)) << (2 * TILE_BITS))
+        | ((r & TILE_MASK) << TILE_BITS) | (c & TILE_MASK);
+}
+
+// Storage offset of (r, c) in either layout
+constexpr int gridIndex(int r, int c, int cols, int tilesPerRow) {
+    return tilesPerRow ? tiledIndex(r, c, tilesPerRow) : r * cols + c;
+}
+
+const size_t CACHE_LINE = 64;
+
+// --- std::vector allocator returning CACHE_LINE-aligned blocks ---
+template <class T>
+struct CacheAlignedAllocator {
+    typedef T value_type;
+
+    CacheAlignedAllocator() = default;
+    template <class U> CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        // Over-allocate and keep the raw pointer just below the aligned block
+        size_t bytes = n * sizeof(T) + CACHE_LINE + sizeof(void*);
+        char* raw = static_cast<char*>(::operator new(bytes));
+        uintptr_t p = reinterpret_cast<uintptr_t>(raw + sizeof(void*));
+        p = (p + CACHE_LINE - 1) & ~uintptr_t(CACHE_LINE - 1);
+        reinterpret_cast<void**>(p)[-1] = raw;
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) {
+        if (p) ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+
+    template <class U> bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+template <class T>
+class Grid {
+public:
+    Grid() = default;
+    Grid(int rows, int cols, const T& v = T()) { resize(rows, cols, v); }
+
+    // --- Shape ---
+    void resize(int rows, int cols, const T& v = T()) {
+        nRows = rows;
+        nCols = cols;
+        tilesPerRow = tilesPerRowFor(cols);
+        size_t n = tilesPerRow ? size_t(tilesFor(rows)) * size_t(tilesPerRow) * TILE_CELLS
+                               : size_t(rows) * size_t(cols);
+        cells.assign(n, v);
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    size_t size() const { return size_t(nRows) * size_t(nCols); } // cells, padding excluded
+    bool empty() const { return cells.empty(); }
+    bool sameShape(int rows, int cols) const { return nRows == rows && nCols == cols; }
+
+    bool inBounds(int r, int c) const {
+        return r >= 0 && r < nRows && c >= 0 && c < nCols;
+    }
+
+    // --- Element access (no bounds checks) ---
+    T& operator()(int r, int c) { return cells[gridIndex(r, c, nCols, tilesPerRow)]; }
+    const T& operator()(int r, int c) const { return cells[gridIndex(r, c, nCols, tilesPerRow)]; }
+
+    // Raw storage (see gridIndex); for kernels and whole-grid copies
+    T* data() { return cells.data(); }
+    const T* data() const { return cells.data(); }
+
+    void fill(const T& v) { std::fill(cells.begin(), cells.end(), v); }
+
+    // --- Layout-hiding traversal ---
+    // Visits every cell of rows r0..r1, cols c0..c1 (inclusive, in bounds)
+    // tile by tile, so tiled grids are walked in storage order: f(r, c, cell).
+    template <class F>
+    void forEachIn(int r0, int c0, int r1, int c1, F f) {
+        for (int tr = r0 >> TILE_BITS; tr <= (r1 >> TILE_BITS); ++tr)
+            for (int tc = c0 >> TILE_BITS; tc <= (c1 >> TILE_BITS); ++tc) {
+                int rs = std::max(r0, tr << TILE_BITS), re = std::min(r1, (tr << TILE_BITS) + TILE_MASK);
+                int cs = std::max(c0, tc << TILE_BITS), ce = std::min(c1, (tc << TILE_BITS) + TILE_MASK);
+                for (int r = rs; r <= re; ++r) {
+                    T* p = &(*this)(r, cs);
+                    for (int c = cs; c <= ce; ++c, ++p)
+                        f(r, c, *p);
+                }
+            }
+    }
+
+    template <class F>
+    void forEach(F f) {
+        if (nRows > 0 && nCols > 0) forEachIn(0, 0, nRows - 1, nCols - 1, f);
+    }
+
+    void fillRect(int r0, int c0, int r1, int c1, const T& v) {
+        forEachIn(r0, c0, r1, c1, [&v](int, int, T& cell) { cell = v; });
+    }
+
+private:
+    int nRows = 0;
+    int nCols = 0;
+    int tilesPerRow = 0; // 0: row-major
+    std::vector<T, CacheAlignedAllocator<T>> cells;
+};
@@ -0,0 +1,668 @@
+#include "GridKernels.h"
+#include "Definitions.h"
+#include "Map.h"
+#include "SafetyMap.h"
+#include "PathNode.h"
+#include "Grid.h"
+#include "Bitboard.h"
+#include <queue>
+#include <algorithm>
+#include <cstdlib>
+
+// ============================================================
+// Compile-time tables
+// ============================================================
+
+// --- 4-neighbourhood (order fixes A* tie-breaking) ---
+static constexpr int NEIGHBOUR_DR[4] = { -1, 1, 0, 0 };
+static constexpr int NEIGHBOUR_DC[4] = { 0, 0, -1, 1 };
+
+// --- Sight disc: half-width of each row of the SIGHT_RANGE disc ---
+struct DiscSpans {
+    int half[2 * SIGHT_RANGE + 1];
+};
+
+static constexpr int discHalfWidth(int range, int dr) {
+    int h = range;
+    while (h > 0 && h * h + dr * dr > range * range) --h;
+    return h;
+}
+
+static constexpr DiscSpans makeSightSpans() {
+    DiscSpans s{};
+    for (int dr = -SIGHT_RANGE; dr <= SIGHT_RANGE; ++dr)
+        s.half[dr + SIGHT_RANGE] = discHalfWidth(SIGHT_RANGE, dr);
+    return s;
+}
+
+static constexpr DiscSpans SIGHT_SPANS = makeSightSpans();
+
+// --- Danger kernel: MAX_DANGER - 2 * max(dist, 1) inside the diamond, 0 outside ---
+static const int DANGER_REACH = SafetyMap::KERNEL_RADIUS - 1;
+static const int DANGER_SIDE = 2 * DANGER_REACH + 1;
+
+struct DangerKernel {
+    int w[DANGER_SIDE][DANGER_SIDE];
+};
+
+static constexpr DangerKernel makeDangerKernel() {
+    DangerKernel k{};
+    for (int dr = -DANGER_REACH; dr <= DANGER_REACH; ++dr)
+        for (int dc = -DANGER_REACH; dc <= DANGER_REACH; ++dc) {
+            int dist = (dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc);
+            if (dist > DANGER_REACH) continue;
+            if (dist < 1) dist = 1;
+            k.w[dr + DANGER_REACH][dc + DANGER_REACH] = SafetyMap::MAX_DANGER - dist * 2;
+        }
+    return k;
+}
+
+static constexpr DangerKernel DANGER_KERNEL = makeDangerKernel();
+
+// ============================================================
+// Bitboard access
+// ============================================================
+template <class D>
+static inline bool bitAt(const D& d, const uint64_t* bits, int r, int c) {
+    return (bits[d.wordIndex(r, c)] >> (c & 63)) & 1;
+}
+
+// 64 cells of row r starting at column c0; off-map cells read 0
+template <class D>
+static inline uint64_t span64(const D& d, const uint64_t* bits, int r, int c0) {
+    if (r < 0 || r >= d.rows()) return 0;
+    const int nWords = (d.cols() + 63) >> 6;
+    const uint64_t* row = bits + d.wordIndex(r, 0);
+
+    int w = (c0 >= 0) ? (c0 >> 6) : -((63 - c0) >> 6); // floor(c0 / 64)
+    int sh = c0 - w * 64;
+    uint64_t lo = (w >= 0 && w < nWords) ? row[w] : 0;
+    uint64_t hi = (w + 1 >= 0 && w + 1 < nWords) ? row[w + 1] : 0;
+    return sh ? ((lo >> sh) | (hi << (64 - sh))) : lo;
+}
+
+// ============================================================
+// Line of sight (Bresenham)
+// ============================================================
+template <class D>
+static inline bool losImpl(const D& d, const uint64_t* vision, const Vec2i& a, const Vec2i& b) {
+    int r0 = a.r, c0 = a.c;
+    int r1 = b.r, c1 = b.c;
+
+    int dr = std::abs(r1 - r0);
+    int dc = std::abs(c1 - c0);
+    int sr = (r0 < r1) ? 1 : -1;
+    int sc = (c0 < c1) ? 1 : -1;
+    int err = dr - dc;
+
+    int r = r0, c = c0;
+    while (true) {
+        if (!(r == r0 && c == c0)) {
+            if (bitAt(d, vision, r, c))
+                return false;
+        }
+
+        if (r == r1 && c == c1)
+            break;
+
+        int e2 = 2 * err;
+        if (e2 > -dc) { err -= dc; r += sr; }
+        if (e2 < dr) { err += dr; c += sc; }
+    }
+    return true;
+}
+
+template <class D>
+static bool lineOfSightKernel(const TerrainBits& t, const Vec2i& a, const Vec2i& b) {
+    return losImpl(D(t.rows, t.cols), t.blocksVision, a, b);
+}
+
+// ============================================================
+// Visibility
+// ============================================================
+template <class D>
+static void sightKernel(const TerrainBits& t, const Vec2i& origin, int range, uint8_t* vis) {
+    const D d(t.rows, t.cols);
+    vis[d.index(origin.r, origin.c)] = 1;
+
+    int rMin = std::max(0, origin.r - range);
+    int rMax = std::min(d.rows() - 1, origin.r + range);
+
+    for (int r = rMin; r <= rMax; ++r) {
+        int dr = r - origin.r;
+        int half = (range == SIGHT_RANGE) ? SIGHT_SPANS.half[dr + SIGHT_RANGE] : discHalfWidth(range, dr);
+        int cMin = std::max(0, origin.c - half);
+        int cMax = std::min(d.cols() - 1, origin.c + half);
+
+        for (int c = cMin; c <= cMax; ++c)
+            if (losImpl(d, t.blocksVision, origin, { r, c }))
+                vis[d.index(r, c)] = 1;
+    }
+}
+
+template <class D>
+static void mergeVisibilityKernel(const uint8_t* src, uint8_t* dst, int rows, int cols,
+    const Vec2i& lo, const Vec2i& hi)
+{
+    const D d(rows, cols);
+    for (int r = lo.r; r <= hi.r; ++r)
+        for (int c = lo.c; c <= hi.c; ++c)
+            dst[d.index(r, c)] |= src[d.index(r, c)];
+}
+
+// ============================================================
+// Danger stamp
+// ============================================================
+template <class D>
+static void stampDangerKernel(int* danger, int rows, int cols, const Vec2i& at) {
+    const D d(rows, cols);
+    int r0 = std::max(0, at.r - DANGER_REACH), r1 = std::min(d.rows() - 1, at.r + DANGER_REACH);
+    int c0 = std::max(0, at.c - DANGER_REACH), c1 = std::min(d.cols() - 1, at.c + DANGER_REACH);
+
+    // Cells outside the diamond add 0, so the whole box is stamped branch-free
+    for (int r = r0; r <= r1; ++r) {
+        const int* w = DANGER_KERNEL.w[r - at.r + DANGER_REACH];
+        for (int c = c0; c <= c1; ++c) {
+            int& cell = danger[d.index(r, c)];
+            cell = std::min(SafetyMap::MAX_DANGER, cell + w[c - at.c + DANGER_REACH]);
+        }
+    }
+}
+
+// ============================================================
+// Cover search
+// ============================================================
+template <class D>
+static bool findCoverKernel(const TerrainBits& t, const Vec2i& origin, int radius, Vec2i& out) {
+    const D d(t.rows, t.cols);
+    int bestR = -1, bestC = -1, bestScore = -1000000000;
+
+    const int c0 = std::max(0, origin.c - radius);
+    const int c1 = std::min(d.cols() - 1, origin.c + radius);
+
+    // Row by row, 64 columns at a time: a candidate is passable and has a
+    // fire blocker in one of its 4 neighbours. Candidates are visited in
+    // row-major order; the first one at the smallest distance wins.
+    for (int rr = std::max(0, origin.r - radius); rr <= std::min(d.rows() - 1, origin.r + radius); ++rr) {
+        for (int cs = c0; cs <= c1; cs += 64) {
+            const int width = std::min(64, c1 - cs + 1);
+            uint64_t inWindow = (width == 64) ? ~uint64_t(0) : ((uint64_t(1) << width) - 1);
+
+            uint64_t passable = ~span64(d, t.blocksMove, rr, cs);
+            uint64_t cover = span64(d, t.blocksFire, rr - 1, cs) | span64(d, t.blocksFire, rr + 1, cs)
+                | span64(d, t.blocksFire, rr, cs - 1) | span64(d, t.blocksFire, rr, cs + 1);
+
+            for (uint64_t m = passable & cover & inWindow; m; m &= m - 1) {
+                int cc = cs + lowestBit(m);
+                int score = -(std::abs(rr - origin.r) + std::abs(cc - origin.c));
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestR = rr;
+                    bestC = cc;
+                }
+            }
+        }
+    }
+
+    if (bestR < 0) return false;
+    out = { bestR, bestC };
+    return true;
+}
+
+// ============================================================
+// A*
+// ============================================================
+
+// Scratch shared by every instantiation, sized to the map. A cell's
+// gScore / closed flag only count when its stamp equals the current
+// search's, so nothing has to be cleared per call.
+struct AStarScratch {
+    Grid<int> gScore;
+    Grid<Vec2i> parent;
+    Grid<uint32_t> openStamp;   // gScore / parent valid
+    Grid<uint32_t> closedStamp; // cell expanded
+    Grid<uint32_t> goalStamp;   // cell is a goal (multi-goal search)
+    Grid<int> gBack;            // backward half of a bidirectional search
+    Grid<Vec2i> parentBack;     // (toward the goal)
+    Grid<uint32_t> openBack;
+    Grid<uint32_t> closedBack;
+    std::vector<int> ringPrefix; // danger ring bound (see DangerRings)
+    uint32_t stamp = 0;
+};
+
+static AStarScratch& beginSearch(int rows, int cols) {
+    static AStarScratch s;
+    if (!s.gScore.sameShape(rows, cols) || s.stamp == UINT32_MAX) {
+        s.gScore.resize(rows, cols, 0);
+        s.parent.resize(rows, cols);
+        s.openStamp.resize(rows, cols, 0);
+        s.closedStamp.resize(rows, cols, 0);
+        s.goalStamp.resize(rows, cols, 0);
+        s.gBack.resize(rows, cols, 0);
+        s.parentBack.resize(rows, cols);
+        s.openBack.resize(rows, cols, 0);
+        s.closedBack.resize(rows, cols, 0);
+        s.stamp = 0;
+    }
+    ++s.stamp;
+    return s;
+}
+
+static long long gExpanded = 0;
+
+long long aStarExpansions() {
+    return gExpanded;
+}
+
+static inline int manh(const Vec2i& a, const Vec2i& b) {
+    return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+}
+
+// Step cost into a cell (shared by the search and the heuristics)
+static inline int stepCost(const int* danger, int idx) {
+    return danger ? 1 + std::max(0, std::min(10, danger[idx] / 10)) : 1;
+}
+
+// --- Danger ring bound ---
+// Each step changes the Manhattan distance to the goal by exactly 1,
+// so a path from a cell D away enters at least one cell of every
+// ring 0..D-1 around the goal. The sum of the cheapest passable step
+// cost per ring is therefore a lower bound, and a consistent one (a
+// step down to ring j costs at least that ring's minimum). Rings are
+// scanned out to the start's distance, at most DANGER_RINGS of them
+// (ring j has 4j cells); beyond that a ring counts 1. Without danger
+// every ring costs 1 and this is plain Manhattan.
+static const int DANGER_RINGS = 64;
+
+struct DangerRings {
+    const int* prefix = nullptr; // prefix[D]: sum of rings 0..D-1
+    int known = 0;               // rings scanned
+
+    int bound(int D) const {
+        return (D <= known) ? prefix[D] : prefix[known] + (D - known);
+    }
+};
+
+template <class D>
+static DangerRings scanDangerRings(const D& d, AStarScratch& s, const TerrainBits& t,
+    const int* danger, const Vec2i& goal, int rings)
+{
+    s.ringPrefix.resize(rings + 1);
+    int* prefix = s.ringPrefix.data();
+    prefix[0] = 0;
+    for (int j = 0; j < rings; ++j) {
+        int cheapest = 11; // dearer than any step; an empty ring is never crossed
+        for (int dr = -j; dr <= j; ++dr) {
+            const int rest = j - std::abs(dr);
+            for (int side = 0; side < (rest ? 2 : 1); ++side) {
+                const int r = goal.r + dr, c = goal.c + (side ? -rest : rest);
+                if (!d.inBounds(r, c) || bitAt(d, t.blocksMove, r, c)) continue;
+                cheapest = std::min(cheapest, stepCost(danger, d.index(r, c)));
+            }
+        }
+        prefix[j + 1] = prefix[j] + cheapest;
+    }
+    DangerRings g;
+    g.prefix = prefix;
+    g.known = rings;
+    return g;
+}
+
+// --- Goal policies ---
+// One goal: ring bound (Manhattan without danger) and a coordinate test.
+struct SingleGoal {
+    Vec2i goal;
+    DangerRings rings;
+    int h(const Vec2i& p, int) const { return rings.bound(manh(p, goal)); }
+    bool reached(const Vec2i& p, int) const { return p.r == goal.r && p.c == goal.c; }
+};
+
+// One goal with ALT bounds: the largest |d(L, goal) - d(L, p)| over
+// the landmarks (unit steps, plus what entering the goal costs beyond
+// 1, paid on every path's last step), or the ring bound if larger.
+struct LandmarkGoal {
+    Vec2i goal;
+    DangerRings rings;
+    int lastStep;
+    const int* dist;
+    int count;
+    int stride;
+    int goalDist[LandmarkView::MAX];
+
+    int h(const Vec2i& p, int idx) const {
+        const int D = manh(p, goal);
+        if (D == 0) return 0;
+        int best = 0;
+        const int* dp = dist + size_t(idx) * stride;
+        for (int k = 0; k < count; ++k) {
+            if (goalDist[k] < 0 || dp[k] < 0) continue;
+            best = std::max(best, std::abs(goalDist[k] - dp[k]));
+        }
+        return std::max(best + lastStep, rings.bound(D));
+    }
+    bool reached(const Vec2i& p, int) const { return p.r == goal.r && p.c == goal.c; }
+};
+
+// Goal set: distance to the nearest goal (still admissible and
+// consistent) and a stamp test, so the first goal popped is the
+// cheapest one to reach.
+struct GoalSet {
+    const Vec2i* goals;
+    int n;
+    const uint32_t* goalStamp;
+    uint32_t stamp;
+    int h(const Vec2i& p, int) const {
+        int best = manh(p, goals[0]);
+        for (int i = 1; i < n; ++i) best = std::min(best, manh(p, goals[i]));
+        return best;
+    }
+    bool reached(const Vec2i&, int idx) const { return goalStamp[idx] == stamp; }
+};
+
+template <class D, class G>
+static bool searchKernel(const D& d, AStarScratch& s, const Vec2i& start, const G& goals,
+    const TerrainBits& t, std::vector<Vec2i>& outPath, const int* danger, Vec2i& found)
+{
+    const uint32_t stamp = s.stamp;
+    int* gScore = s.gScore.data();
+    Vec2i* parent = s.parent.data();
+    uint32_t* openStamp = s.openStamp.data();
+    uint32_t* closedStamp = s.closedStamp.data();
+
+    std::priority_queue<PathNode, std::vector<PathNode>, ComparePathNode> open;
+    const int startIdx = d.index(start.r, start.c);
+    gScore[startIdx] = 0;
+    parent[startIdx] = { -1, -1 };
+    openStamp[startIdx] = stamp;
+    open.push(PathNode(start.r, start.c, 0, goals.h(start, startIdx), { -1, -1 }));
+
+    while (!open.empty()) {
+        PathNode cur = open.top();
+        open.pop();
+
+        const int curIdx = d.index(cur.p.r, cur.p.c);
+        if (closedStamp[curIdx] == stamp) continue;
+        closedStamp[curIdx] = stamp;
+        ++gExpanded;
+
+        // Goal reached: reconstruct path
+        if (goals.reached(cur.p, curIdx)) {
+            found = cur.p;
+            Vec2i v = cur.p;
+            while (!(v.r == start.r && v.c == start.c)) {
+                outPath.push_back(v);
+                Vec2i pr = parent[d.index(v.r, v.c)];
+                if (pr.r == -1) break;
+                v = pr;
+            }
+            std::reverse(outPath.begin(), outPath.end());
+            return true;
+        }
+
+        // Explore neighbors (TREE is passable)
+        for (int k = 0; k < 4; ++k) {
+            int nr = cur.p.r + NEIGHBOUR_DR[k];
+            int nc = cur.p.c + NEIGHBOUR_DC[k];
+            if (!d.inBounds(nr, nc)) continue;
+
+            if (bitAt(d, t.blocksMove, nr, nc)) continue;
+            const int idx = d.index(nr, nc);
+
+            int tentative = cur.g + stepCost(danger, idx);
+            int known = (openStamp[idx] == stamp) ? gScore[idx] : 1000000000;
+            if (tentative < known) {
+                gScore[idx] = tentative;
+                parent[idx] = cur.p;
+                openStamp[idx] = stamp;
+                int f = tentative + goals.h({ nr, nc }, idx);
+                open.push(PathNode(nr, nc, tentative, f, cur.p));
+            }
+        }
+    }
+
+    // No path found
+    return false;
+}
+
+template <class D>
+static bool aStarKernel(const TerrainBits& t, const Vec2i& start, const Vec2i& goal,
+    std::vector<Vec2i>& outPath, const int* danger, const LandmarkView* landmarks)
+{
+    const D d(t.rows, t.cols);
+    outPath.clear();
+    if (start.r == goal.r && start.c == goal.c)
+        return true;
+
+    AStarScratch& s = beginSearch(t.rows, t.cols);
+    const int goalIdx = d.index(goal.r, goal.c);
+    DangerRings rings;
+    s.ringPrefix.assign(1, 0);
+    rings.prefix = s.ringPrefix.data();
+    if (danger) rings = scanDangerRings(d, s, t, danger, goal, std::min(DANGER_RINGS, manh(start, goal)));
+    Vec2i found;
+
+    if (landmarks && landmarks->count > 0) {
+        LandmarkGoal g;
+        g.goal = goal;
+        g.rings = rings;
+        g.lastStep = stepCost(danger, goalIdx) - 1;
+        g.dist = landmarks->dist;
+        g.count = std::min(landmarks->count, int(LandmarkView::MAX));
+        g.stride = landmarks->stride;
+        for (int k = 0; k < g.count; ++k)
+            g.goalDist[k] = g.dist[size_t(goalIdx) * g.stride + k];
+        return searchKernel(d, s, start, g, t, outPath, danger, found);
+    }
+
+    SingleGoal g{ goal, rings };
+    return searchKernel(d, s, start, g, t, outPath, danger, found);
+}
+
+template <class D>
+static int aStarNearestKernel(const TerrainBits& t, const Vec2i& start,
+    const Vec2i* goals, int nGoals, std::vector<Vec2i>& outPath, const int* danger)
+{
+    const D d(t.rows, t.cols);
+    outPath.clear();
+    if (nGoals <= 0) return -1;
+    for (int i = 0; i < nGoals; ++i)
+        if (goals[i].r == start.r && goals[i].c == start.c) return i;
+
+    AStarScratch& s = beginSearch(t.rows, t.cols);
+    uint32_t* goalStamp = s.goalStamp.data();
+    for (int i = 0; i < nGoals; ++i)
+        goalStamp[d.index(goals[i].r, goals[i].c)] = s.stamp;
+
+    GoalSet g{ goals, nGoals, goalStamp, s.stamp };
+    Vec2i found;
+    if (!searchKernel(d, s, start, g, t, outPath, danger, found)) return -1;
+    for (int i = 0; i < nGoals; ++i)
+        if (goals[i].r == found.r && goals[i].c == found.c) return i;
+    return -1;
+}
+
+// --- Bidirectional (unit cost) ---
+// Forward from the start toward the goal and backward from the goal
+// toward the start, always expanding the side with the smaller open
+// list. Whenever one side reaches a cell the other has reached, the
+// two halves give a path of length g_forward + g_backward; the best
+// one, mu, is final once mu <= max(min f forward, min f backward).
+// With consistent heuristics any shorter path would still have an
+// open cell on each side with f no larger than its length, so the
+// rule never stops early. Each side uses a one-goal policy (its own
+// ALT bounds when there are tables).
+//
+// On open ground every monotone staircase between the ends ties on
+// f and g, and two fronts that pick different staircases only touch
+// near the far end. Remaining ties go to the cell nearer the straight
+// start-goal line, so both fronts follow it and meet near the middle.
+// Heap order of ComparePathNode, then the cell nearer the start-goal line
+// (cross product with the line direction)
+struct CompareNearLine {
+    Vec2i s, t;
+    int off(const Vec2i& p) const {
+        return std::abs((p.r - s.r) * (t.c - s.c) - (p.c - s.c) * (t.r - s.r));
+    }
+    bool operator()(const PathNode& a, const PathNode& b) const {
+        if (a.f != b.f) return a.f > b.f;
+        if (a.g != b.g) return a.g < b.g;
+        return off(a.p) > off(b.p);
+    }
+};
+
+template <class D>
+struct SearchSide {
+    std::priority_queue<PathNode, std::vector<PathNode>, CompareNearLine> open;
+    int* g;
+    Vec2i* parent;
+    uint32_t* seen;
+    uint32_t* closed;
+
+    // Pops closed entries; lowest f still open (or a large value)
+    int minF(const D& d, uint32_t stamp) {
+        while (!open.empty() && closed[d.index(open.top().p.r, open.top().p.c)] == stamp)
+            open.pop();
+        return open.empty() ? 1000000000 : open.top().f;
+    }
+};
+
+template <class D, class G>
+static bool biSearchKernel(const D& d, AStarScratch& s, const Vec2i& start, const Vec2i& goal,
+    const G& toGoal, const G& toStart, const TerrainBits& t, std::vector<Vec2i>& outPath)
+{
+    const uint32_t stamp = s.stamp;
+    const CompareNearLine line{ start, goal };
+    SearchSide<D> fwd{ decltype(SearchSide<D>::open)(line), s.gScore.data(), s.parent.data(), s.openStamp.data(), s.closedStamp.data() };
+    SearchSide<D> bwd{ decltype(SearchSide<D>::open)(line), s.gBack.data(), s.parentBack.data(), s.openBack.data(), s.closedBack.data() };
+
+    const int startIdx = d.index(start.r, start.c), goalIdx = d.index(goal.r, goal.c);
+    fwd.g[startIdx] = 0;
+    fwd.parent[startIdx] = { -1, -1 };
+    fwd.seen[startIdx] = stamp;
+    fwd.open.push(PathNode(start.r, start.c, 0, toGoal.h(start, startIdx), { -1, -1 }));
+    bwd.g[goalIdx] = 0;
+    bwd.parent[goalIdx] = { -1, -1 };
+    bwd.seen[goalIdx] = stamp;
+    bwd.open.push(PathNode(goal.r, goal.c, 0, toStart.h(goal, goalIdx), { -1, -1 }));
+
+    int best = 1000000000;
+    Vec2i meet{ -1, -1 };
+
+    while (true) {
+        const int fF = fwd.minF(d, stamp), fB = bwd.minF(d, stamp);
+        if (fwd.open.empty() || bwd.open.empty() || best <= std::max(fF, fB)) break;
+
+        const bool forward = fwd.open.size() <= bwd.open.size();
+        SearchSide<D>& me = forward ? fwd : bwd;
+        SearchSide<D>& other = forward ? bwd : fwd;
+        const G& policy = forward ? toGoal : toStart;
+
+        PathNode cur = me.open.top();
+        me.open.pop();
+        me.closed[d.index(cur.p.r, cur.p.c)] = stamp;
+        ++gExpanded;
+
+        for (int k = 0; k < 4; ++k) {
+            int nr = cur.p.r + NEIGHBOUR_DR[k];
+            int nc = cur.p.c + NEIGHBOUR_DC[k];
+            if (!d.inBounds(nr, nc)) continue;
+
+            if (bitAt(d, t.blocksMove, nr, nc)) continue;
+            const int idx = d.index(nr, nc);
+
+            int tentative = cur.g + 1;
+            int known = (me.seen[idx] == stamp) ? me.g[idx] : 1000000000;
+            if (tentative < known && me.closed[idx] != stamp) {
+                me.g[idx] = known = tentative;
+                me.parent[idx] = cur.p;
+                me.seen[idx] = stamp;
+                me.open.push(PathNode(nr, nc, tentative, tentative + policy.h({ nr, nc }, idx), cur.p));
+            }
+            if (other.seen[idx] == stamp && known + other.g[idx] < best) {
+                best = known + other.g[idx];
+                meet = { nr, nc };
+            }
+        }
+    }
+    if (meet.r < 0) return false;
+
+    // Start .. meet along forward parents, then meet .. goal along backward ones
+    for (Vec2i v = meet; !(v.r == start.r && v.c == start.c); v = fwd.parent[d.index(v.r, v.c)])
+        outPath.push_back(v);
+    std::reverse(outPath.begin(), outPath.end());
+    for (Vec2i v = bwd.parent[d.index(meet.r, meet.c)]; v.r >= 0; v = bwd.parent[d.index(v.r, v.c)])
+        outPath.push_back(v);
+    return true;
+}
+
+template <class D>
+static bool aStarBidirectionalKernel(const TerrainBits& t, const Vec2i& start, const Vec2i& goal,
+    std::vector<Vec2i>& outPath, const LandmarkView* landmarks)
+{
+    const D d(t.rows, t.cols);
+    outPath.clear();
+    if (start.r == goal.r && start.c == goal.c)
+        return true;
+
+    AStarScratch& s = beginSearch(t.rows, t.cols);
+    s.ringPrefix.assign(1, 0);
+    DangerRings rings;
+    rings.prefix = s.ringPrefix.data();
+
+    if (landmarks && landmarks->count > 0) {
+        LandmarkGoal toGoal, toStart;
+        toGoal.goal = goal;
+        toStart.goal = start;
+        for (LandmarkGoal* g : { &toGoal, &toStart }) {
+            g->rings = rings;
+            g->lastStep = 0;
+            g->dist = landmarks->dist;
+            g->count = std::min(landmarks->count, int(LandmarkView::MAX));
+            g->stride = landmarks->stride;
+            const int idx = d.index(g->goal.r, g->goal.c);
+            for (int k = 0; k < g->count; ++k)
+                g->goalDist[k] = g->dist[size_t(idx) * g->stride + k];
+        }
+        return biSearchKernel(d, s, start, goal, toGoal, toStart, t, outPath);
+    }
+
+    SingleGoal toGoal{ goal, rings }, toStart{ start, rings };
+    return biSearchKernel(d, s, start, goal, toGoal, toStart, t, outPath);
+}
+
+// ============================================================
+// Kernel sets
+// ============================================================
+template <class D>
+static GridKernels makeKernels(const char* name) {
+    GridKernels k;
+    k.name = name;
+    k.lineOfSight = &lineOfSightKernel<D>;
+    k.sight = &sightKernel<D>;
+    k.mergeVisibility = &mergeVisibilityKernel<D>;
+    k.stampDanger = &stampDangerKernel<D>;
+    k.findCover = &findCoverKernel<D>;
+    k.aStar = &aStarKernel<D>;
+    k.aStarNearest = &aStarNearestKernel<D>;
+    k.aStarBidirectional = &aStarBidirectionalKernel<D>;
+    return k;
+}
+
+const GridKernels& selectGridKernels(int rows, int cols) {
+    static const GridKernels k40 = makeKernels<FixedDims<40, 40> >("40x40");
+    static const GridKernels k64 = makeKernels<FixedDims<64, 64> >("64x64");
+    static const GridKernels k128 = makeKernels<FixedDims<128, 128> >("128x128");
+    static const GridKernels k256 = makeKernels<FixedDims<256, 256> >("256x256");
+    static const GridKernels kAny = makeKernels<RuntimeDims>("runtime");
+    static const GridKernels kTiled = makeKernels<TiledDims>("tiled");
+
+    if (rows == cols) {
+        switch (rows) {
+        case 40:  return k40;
+        case 64:  return k64;
+        case 128: return k128;
+        case 256: return k256;
+        }
+    }
+    return tilesPerRowFor(cols) ? kTiled : kAny;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include <vector>
+#include <cstdint>
+
+// ============================================================
+// GridKernels.h
+// Hot per-cell loops (line of sight, visibility, visibility
+// union, danger stamp, cover search, A*) compiled once per
+// standard map shape. In a FixedDims instantiation the row
+// stride and bounds are compile-time constants, so index math
+// and bounds checks fold away; RuntimeDims and TiledDims cover
+// every other row-major and tiled shape. A match picks its kernel set once, when the Map is
+// built (Map::kernels()).
+//
+// Terrain comes in as the Map's capability bitboards (row words,
+// see Bitboard.h); danger and visibility fields as raw Grid
+// storage (index() matches Grid's layout, row-major or tiled).
+// ============================================================
+
+// --- Dimension policies ---
+template <int ROWS, int COLS>
+struct FixedDims {
+    FixedDims(int, int) {}
+    static constexpr int rows() { return ROWS; }
+    static constexpr int cols() { return COLS; }
+    static constexpr bool inBounds(int r, int c) {
+        return unsigned(r) < unsigned(ROWS) && unsigned(c) < unsigned(COLS);
+    }
+    static constexpr int index(int r, int c) { return gridIndex(r, c, COLS, tilesPerRowFor(COLS)); }
+    static constexpr int wordIndex(int r, int c) { return r * ((COLS + 63) >> 6) + (c >> 6); }
+};
+
+// Any row-major shape (narrower than TILED_MIN_COLS)
+struct RuntimeDims {
+    RuntimeDims(int r, int c) : nRows(r), nCols(c), nWords((c + 63) >> 6) {}
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    bool inBounds(int r, int c) const {
+        return unsigned(r) < unsigned(nRows) && unsigned(c) < unsigned(nCols);
+    }
+    int index(int r, int c) const { return r * nCols + c; }
+    int wordIndex(int r, int c) const { return r * nWords + (c >> 6); }
+
+    int nRows;
+    int nCols;
+    int nWords;
+};
+
+// Any tiled shape (TILED_MIN_COLS wide or more)
+struct TiledDims {
+    TiledDims(int r, int c) : nRows(r), nCols(c), tilesPerRow(tilesFor(c)), nWords((c + 63) >> 6) {}
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    bool inBounds(int r, int c) const {
+        return unsigned(r) < unsigned(nRows) && unsigned(c) < unsigned(nCols);
+    }
+    int index(int r, int c) const { return tiledIndex(r, c, tilesPerRow); }
+    int wordIndex(int r, int c) const { return r * nWords + (c >> 6); }
+
+    int nRows;
+    int nCols;
+    int tilesPerRow;
+    int nWords;
+};
+
+// --- Terrain capability bitboards of one map (Map::terrainBits()) ---
+struct TerrainBits {
+    int rows;
+    int cols;
+    const uint64_t* blocksMove;   // ROCK, WATER
+    const uint64_t* blocksVision; // ROCK, TREE
+    const uint64_t* blocksFire;   // ROCK, TREE (what counts as cover)
+};
+
+// --- Landmark distance tables (Landmarks::view()) ---
+// dist[index * stride + k]: steps from landmark k to the cell at
+// storage index 'index' (Grid layout), -1 if out of its reach
+struct LandmarkView {
+    static const int MAX = 16;
+    int count = 0;   // 0: no tables, plain Manhattan heuristic
+    int stride = 0;
+    const int* dist = nullptr;
+};
+
+// --- Kernel set for one map shape ---
+struct GridKernels {
+    const char* name; // e.g. "40x40", "runtime", "tiled"
+
+    // Bresenham: no vision-blocking cell strictly after 'a' up to and including 'b'
+    bool (*lineOfSight)(const TerrainBits& t, const Vec2i& a, const Vec2i& b);
+
+    // Marks every cell of the sight disc around 'origin' that is in line of sight
+    // ('vis' must already be cleared over that disc)
+    void (*sight)(const TerrainBits& t, const Vec2i& origin, int range, uint8_t* vis);
+
+    // dst |= src over the window [lo, hi]
+    void (*mergeVisibility)(const uint8_t* src, uint8_t* dst, int rows, int cols,
+        const Vec2i& lo, const Vec2i& hi);
+
+    // Adds one enemy's danger kernel around 'at' (saturating at SafetyMap::MAX_DANGER)
+    void (*stampDanger)(int* danger, int rows, int cols, const Vec2i& at);
+
+    // Nearest passable cell next to a fire blocker within 'radius' (Chebyshev) of 'origin'
+    bool (*findCover)(const TerrainBits& t, const Vec2i& origin, int radius, Vec2i& out);
+
+    // A* over passable cells; 'danger' (optional) adds min(danger / 10, 10) per step.
+    // 'landmarks' (optional) tightens the heuristic with ALT bounds.
+    bool (*aStar)(const TerrainBits& t, const Vec2i& start, const Vec2i& goal,
+        std::vector<Vec2i>& outPath, const int* danger, const LandmarkView* landmarks);
+
+    // Same search toward a goal set, stopping at the first (cheapest) goal
+    // reached; returns its index, or -1 if none is reachable
+    int (*aStarNearest)(const TerrainBits& t, const Vec2i& start, const Vec2i* goals, int nGoals,
+        std::vector<Vec2i>& outPath, const int* danger);
+
+    // Unit-cost A* from both ends at once (shortest path, as aStar without danger)
+    bool (*aStarBidirectional)(const TerrainBits& t, const Vec2i& start, const Vec2i& goal,
+        std::vector<Vec2i>& outPath, const LandmarkView* landmarks);
+};
+
+// Nodes expanded by every A* so far (diagnostics and benchmarks)
+long long aStarExpansions();
+
+// Specialised set for 40x40, 64x64, 128x128 and 256x256; runtime or tiled set otherwise
+const GridKernels& selectGridKernels(int rows, int cols);
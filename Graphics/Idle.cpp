@@ -1,6 +1,11 @@
 #include "Idle.h"
 #include "Agent.h"
 
+Idle* Idle::instance() {
+    static Idle s;
+    return &s;
+}
+
 void Idle::OnEnter(Agent* /*a*/) {}
 void Idle::Transition(Agent* /*a*/) {}
 void Idle::OnExit(Agent* /*a*/) {}
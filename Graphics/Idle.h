@@ -6,6 +6,8 @@
 // ============================================================
 class Idle : public State {
 public:
+    static Idle* instance(); // shared flyweight
+
     void OnEnter(Agent* a) override;
     void Transition(Agent* a) override;
     void OnExit(Agent* a) override;
@@ -0,0 +1,111 @@
+#include "Landmarks.h"
+#include "Map.h"
+#include "BitBfs.h"
+#include <algorithm>
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// Passable cell nearest the map centre, {-1, -1} if there is none
+static Vec2i centreCell(const Map& world) {
+    const int R = world.rows(), C = world.cols();
+    for (int ring = 0; ring <= std::max(R, C); ++ring)
+        for (int r = R / 2 - ring; r <= R / 2 + ring; ++r)
+            for (int c = C / 2 - ring; c <= C / 2 + ring; ++c)
+                if (world.inBounds(r, c) && !world.blocksMovement(r, c)) return { r, c };
+    return { -1, -1 };
+}
+
+// Cell with the largest distance in 'field', {-1, -1} if all are <= 0
+static Vec2i farthestCell(Grid<int>& field) {
+    Vec2i far{ -1, -1 };
+    int best = 0;
+    field.forEach([&](int r, int c, int& d) {
+        if (d > best) { best = d; far = { r, c }; }
+    });
+    return far;
+}
+
+// Steps over Manhattan distance, summed over everything 'from' reaches
+static double detourOf(Grid<int>& field, const Vec2i& from) {
+    long long steps = 0, straight = 0;
+    field.forEach([&](int r, int c, int& d) {
+        if (d <= 0) return;
+        steps += d;
+        straight += std::abs(r - from.r) + std::abs(c - from.c);
+    });
+    return straight ? double(steps) / double(straight) : 1.0;
+}
+
+// ============================================================
+// Update
+// ============================================================
+void Landmarks::update(const Map& world, double minDetour) {
+    if (builtFor == world.terrainVersion()) return;
+    builtFor = world.terrainVersion();
+
+    const int R = world.rows(), C = world.cols();
+    detourFactor = 1.0;
+    if ((long long)R * C > MAX_CELLS) {
+        marks.clear();
+        return;
+    }
+    if (!table.sameShape(R, C)) {
+        table.resize(R, C);
+        marks.clear();
+    }
+
+    // Probe flood from the centre: on open ground Manhattan is already
+    // (nearly) exact and the tables would only cost lookups
+    std::vector<Vec2i> source(1, centreCell(world));
+    if (source[0].r < 0) {
+        marks.clear();
+        return;
+    }
+    Grid<int> probe;
+    BitBfs::distanceField(world, source, probe);
+    detourFactor = detourOf(probe, source[0]);
+    if (detourFactor < minDetour) {
+        marks.clear();
+        return;
+    }
+
+    // Landmarks the terrain change has blocked are dropped; the rest
+    // keep their place and only get fresh tables
+    marks.erase(std::remove_if(marks.begin(), marks.end(),
+        [&world](const Vec2i& p) { return world.blocksMovement(p.r, p.c); }), marks.end());
+
+    // minDist: steps to the nearest landmark so far (-1 out of reach)
+    Grid<int> dist, minDist(R, C, -1);
+    auto addLandmark = [&](int k) {
+        source[0] = marks[k];
+        BitBfs::distanceField(world, source, dist);
+        table.forEach([&dist, k](int r, int c, Entry& e) { e.d[k] = dist(r, c); });
+        minDist.forEach([&dist](int r, int c, int& m) {
+            int d = dist(r, c);
+            if (d >= 0 && (m < 0 || d < m)) m = d;
+        });
+    };
+    for (int k = 0; k < (int)marks.size(); ++k) addLandmark(k);
+
+    // Farthest-point selection for the rest; the first new one is
+    // the cell farthest from the probe
+    while ((int)marks.size() < COUNT) {
+        Vec2i far = farthestCell(marks.empty() ? probe : minDist);
+        if (far.r < 0) break; // every reachable cell is a landmark already
+        marks.push_back(far);
+        addLandmark((int)marks.size() - 1);
+    }
+}
+
+// ============================================================
+// Kernel view
+// ============================================================
+LandmarkView Landmarks::view() const {
+    LandmarkView v;
+    v.count = (int)marks.size();
+    v.stride = COUNT;
+    v.dist = v.count ? table.data()->d : nullptr;
+    return v;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Types.h"
+#include "Grid.h"
+#include "GridKernels.h"
+#include <vector>
+#include <cstdint>
+
+// Forward declaration
+class Map;
+
+// ============================================================
+// Landmarks
+// Distance tables for the ALT heuristic (A*, Landmarks, Triangle
+// inequality). For a landmark L, |d(L, goal) - d(L, x)| never
+// exceeds the step count from x to the goal, and every step costs
+// at least 1 with or without danger, so the largest such bound
+// (or Manhattan, whichever is bigger) stays admissible and
+// consistent for danger-weighted searches too. Around water and
+// rock blobs it is far tighter than Manhattan alone.
+//
+// Landmarks are spread by farthest-point selection: each new one
+// is the cell farthest (in steps) from those already chosen. The
+// tables are unit-cost BitBfs distance fields, one per landmark.
+// After a terrain change the landmarks that are still passable are
+// kept and only the tables are re-derived, on the first query.
+//
+// A probe flood first measures how far true distances stray from
+// Manhattan. On open ground (the generated maps sit around 1.002)
+// Manhattan is already exact almost everywhere, so no tables are
+// built unless the detour reaches the caller's threshold.
+// ============================================================
+class Landmarks {
+public:
+    static const int COUNT = 8;               // <= LandmarkView::MAX
+    static const int MAX_CELLS = 512 * 512;   // larger maps: plain Manhattan
+
+    // Detour from which the tables pay for their lookups
+    static constexpr double USEFUL_DETOUR = 1.05;
+
+    // Brings the tables up to date with the map's terrain version;
+    // none are kept if the terrain's detour is below 'minDetour'
+    void update(const Map& world, double minDetour = USEFUL_DETOUR);
+
+    // Table view for the A* kernels (count 0 if there are none)
+    LandmarkView view() const;
+
+    const std::vector<Vec2i>& cells() const { return marks; }
+
+    // Ratio of true steps to Manhattan distance from the map centre
+    // (1.0 on open ground); how much room ALT has over Manhattan
+    double detour() const { return detourFactor; }
+
+private:
+    struct Entry {
+        int d[COUNT];
+    };
+
+    std::vector<Vec2i> marks;
+    Grid<Entry> table;      // per cell: steps from each landmark, -1 if unreachable
+    uint32_t builtFor = 0;  // Map::terrainVersion of the tables
+    double detourFactor = 1.0;
+};
@@ -1,4 +1,5 @@
 ﻿#include "Map.h"
+#include "BitBfs.h"
 #include "glut.h"
 #include <cstdlib>
 #include <algorithm>
@@ -6,17 +7,63 @@
 // ============================================================
 // Constructor
 // ============================================================
-Map::Map() {
-    for (int i = 0; i < MSZ; ++i)
-        for (int j = 0; j < MSZ; ++j)
-            grid[i][j] = EMPTY;
+Map::Map(int rows, int cols)
+    : nRows(rows), nCols(cols), bytesPerRow((cols + 1) / 2),
+    kernelSet(&selectGridKernels(rows, cols)) {
+    types.assign(size_t(rows) * bytesPerRow, 0); // EMPTY
+    moveBlock.resize(rows, cols);
+    visionBlock.resize(rows, cols);
+    fireBlock.resize(rows, cols);
+    bumpVersion();
+}
+
+void Map::bumpVersion() {
+    static uint32_t lastVersion = 0;
+    version = ++lastVersion;
+    componentsDirty = true;
+}
+
+// ============================================================
+// Terrain
+// ============================================================
+void Map::set(int r, int c, CellType t) {
+    uint8_t& b = types[typeByte(r, c)];
+    const int shift = (c & 1) * 4;
+    b = uint8_t((b & ~(0xF << shift)) | ((int(t) & 0xF) << shift));
+
+    if (moveBlock.test(r, c) != BlocksMovement(t)) bumpVersion();
+    moveBlock.set(r, c, BlocksMovement(t));
+    visionBlock.set(r, c, BlocksVision(t));
+    fireBlock.set(r, c, BlocksFire(t));
+}
+
+TerrainBits Map::terrainBits() const {
+    TerrainBits t;
+    t.rows = nRows;
+    t.cols = nCols;
+    t.blocksMove = moveBlock.data();
+    t.blocksVision = visionBlock.data();
+    t.blocksFire = fireBlock.data();
+    return t;
 }
 
 // ============================================================
-// Boundaries
+// Team bases
 // ============================================================
-bool Map::inBounds(int r, int c) const {
-    return r >= 0 && r < MSZ && c >= 0 && c < MSZ;
+Vec2i Map::medStorage(TeamColor t) const {
+    return (t == TEAM_ORANGE) ? Vec2i{ 6, 6 } : Vec2i{ rows() - 7, cols() - 7 };
+}
+
+Vec2i Map::ammoStorage(TeamColor t) const {
+    return (t == TEAM_ORANGE) ? Vec2i{ 6, 9 } : Vec2i{ rows() - 7, cols() - 10 };
+}
+
+Vec2i Map::rallyCorner(TeamColor t, int inset) const {
+    return (t == TEAM_ORANGE) ? Vec2i{ inset, inset } : Vec2i{ rows() - inset, cols() - inset };
+}
+
+Vec2i Map::clampCell(int r, int c) const {
+    return { std::max(0, std::min(rows() - 1, r)), std::max(0, std::min(cols() - 1, c)) };
 }
 
 // ============================================================
@@ -41,10 +88,10 @@ static void stampBlob(Map& m, int sr, int sc, int n, CellType t) {
 
         // ✅ manual clamp for full C++ compatibility
         if (r < 1) r = 1;
-        else if (r > MSZ - 2) r = MSZ - 2;
+        else if (r > m.rows() - 2) r = m.rows() - 2;
 
         if (c < 1) c = 1;
-        else if (c > MSZ - 2) c = MSZ - 2;
+        else if (c > m.cols() - 2) c = m.cols() - 2;
     }
 }
 
@@ -52,44 +99,50 @@ static void stampBlob(Map& m, int sr, int sc, int n, CellType t) {
 // Map initialization
 // ============================================================
 void Map::initStructured() {
+    const int R = rows(), C = cols();
+
     // Clear map
-    for (int i = 0; i < MSZ; ++i)
-        for (int j = 0; j < MSZ; ++j)
-            grid[i][j] = EMPTY;
+    std::fill(types.begin(), types.end(), uint8_t(0));
+    moveBlock.clear();
+    visionBlock.clear();
+    fireBlock.clear();
+    bumpVersion();
+
+    // Cluster density of the standard 40x40 map (7 of each per 1600 cells)
+    const int numClusters = std::max(7, int((long long)R * C * 7 / 1600));
 
     // --- WATER clusters (light blue) ---
-    for (int i = 0; i < 7; ++i) {
-        int r = 8 + rand() % (MSZ - 16);
-        int c = 8 + rand() % (MSZ - 16);
+    for (int i = 0; i < numClusters; ++i) {
+        int r = 8 + rand() % (R - 16);
+        int c = 8 + rand() % (C - 16);
         int n = 3 + rand() % 3; // 3–5 cells
         stampBlob(*this, r, c, n, WATER);
     }
 
     // --- ROCK clusters (dark gray/brown) ---
-    for (int i = 0; i < 7; ++i) {
-        int r = 8 + rand() % (MSZ - 16);
-        int c = 8 + rand() % (MSZ - 16);
+    for (int i = 0; i < numClusters; ++i) {
+        int r = 8 + rand() % (R - 16);
+        int c = 8 + rand() % (C - 16);
         int n = 3 + rand() % 3;
         stampBlob(*this, r, c, n, ROCK);
     }
 
     // --- TREES (scattered, green triangles) ---
-    int numTrees = (MSZ * MSZ) / 80;
+    int numTrees = int((long long)R * C / 80);
     for (int i = 0; i < numTrees; ++i) {
-        int r = 6 + rand() % (MSZ - 12);
-        int c = 6 + rand() % (MSZ - 12);
-        if (grid[r][c] == EMPTY)
-            grid[r][c] = TREE;
+        int r = 6 + rand() % (R - 12);
+        int c = 6 + rand() % (C - 12);
+        if (at(r, c) == EMPTY)
+            set(r, c, TREE);
     }
 
     // --- WAREHOUSES (ammo + med for each team) ---
-    // Orange team (bottom-left)
-    set(6, 6, SUPPLY_AMMO);
-    set(6, 9, SUPPLY_MED);
-
-    // Blue team (top-right)
-    set(MSZ - 7, MSZ - 7, SUPPLY_AMMO);
-    set(MSZ - 7, MSZ - 10, SUPPLY_MED);
+    // Orange team (bottom-left), Blue team (top-right)
+    for (TeamColor t : { TEAM_ORANGE, TEAM_BLUE }) {
+        Vec2i med = medStorage(t), ammo = ammoStorage(t);
+        set(med.r, med.c, SUPPLY_MED);
+        set(ammo.r, ammo.c, SUPPLY_AMMO);
+    }
 }
 
 // ============================================================
@@ -109,7 +162,7 @@ void Map::drawCell(int r, int c) const {
     double x0 = c + inset, y0 = r + inset;
     double x1 = c + 1 - inset, y1 = r + 1 - inset;
 
-    switch ((CellType)grid[r][c]) {
+    switch (at(r, c)) {
     case EMPTY:
         break;
 
@@ -171,8 +224,8 @@ void Map::drawCell(int r, int c) const {
 }
 
 void Map::draw() const {
-    for (int i = 0; i < MSZ; ++i)
-        for (int j = 0; j < MSZ; ++j)
+    for (int i = 0; i < rows(); ++i)
+        for (int j = 0; j < cols(); ++j)
             drawCell(i, j);
 }
 
@@ -180,29 +233,43 @@ void Map::draw() const {
 // Line of Sight - Bresenham grid tracing
 // ============================================================
 bool Map::hasLineOfSight(const Vec2i& a, const Vec2i& b) const {
-    int r0 = a.r, c0 = a.c;
-    int r1 = b.r, c1 = b.c;
-
-    int dr = std::abs(r1 - r0);
-    int dc = std::abs(c1 - c0);
-    int sr = (r0 < r1) ? 1 : -1;
-    int sc = (c0 < c1) ? 1 : -1;
-    int err = dr - dc;
-
-    int r = r0, c = c0;
-    while (true) {
-        if (!(r == r0 && c == c0)) {
-            CellType ct = at(r, c);
-            if (BlocksVision(ct))
-                return false;
-        }
-
-        if (r == r1 && c == c1)
-            break;
-
-        int e2 = 2 * err;
-        if (e2 > -dc) { err -= dc; r += sr; }
-        if (e2 < dr) { err += dr; c += sc; }
+    return kernelSet->lineOfSight(terrainBits(), a, b);
+}
+
+// ============================================================
+// Connectivity
+// ============================================================
+static const int STEP_DR[4] = { 1, -1, 0, 0 };
+static const int STEP_DC[4] = { 0, 0, 1, -1 };
+
+void Map::labelComponents() const {
+    BitBfs::labelComponents(*this, components, componentCells);
+    componentsDirty = false;
+}
+
+int Map::componentOf(int r, int c) const {
+    if (componentsDirty) labelComponents();
+    return components(r, c);
+}
+
+int Map::componentSize(int label) const {
+    if (componentsDirty) labelComponents();
+    return (label >= 0 && label < (int)componentCells.size()) ? componentCells[label] : 0;
+}
+
+bool Map::connected(const Vec2i& from, const Vec2i& to) const {
+    if (from.r == to.r && from.c == to.c) return true;
+    if (!inBounds(from.r, from.c) || !inBounds(to.r, to.c)) return false;
+
+    const int goal = componentOf(to.r, to.c);
+    if (goal < 0) return false;
+
+    // A blocked start (an agent on a rock) still leaves through its neighbours
+    if (componentOf(from.r, from.c) == goal) return true;
+    if (!blocksMovement(from.r, from.c)) return false;
+    for (int k = 0; k < 4; ++k) {
+        int nr = from.r + STEP_DR[k], nc = from.c + STEP_DC[k];
+        if (inBounds(nr, nc) && components(nr, nc) == goal) return true;
     }
-    return true;
+    return false;
 }
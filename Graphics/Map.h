@@ -1,6 +1,11 @@
 #pragma once
 #include "Types.h"
 #include "Definitions.h"
+#include "Grid.h"
+#include "Bitboard.h"
+#include "GridKernels.h"
+#include <vector>
+#include <cstdint>
 
 // ============================================================
 // Map.h
@@ -18,22 +23,82 @@ inline bool BlocksFire(CellType t) { return (t == ROCK || t == TREE); }
 // ------------------------------------------------------------
 class Map {
 public:
-    Map();
+    Map(int rows = DEFAULT_MAP_SIZE, int cols = DEFAULT_MAP_SIZE);
 
     // --- Core operations ---
     void initStructured();   // generate a structured environment (clusters + warehouses)
     void draw() const;       // render the entire map
-    bool inBounds(int r, int c) const;
+    bool inBounds(int r, int c) const {
+        return r >= 0 && r < nRows && c >= 0 && c < nCols;
+    }
+
+    // --- Dimensions ---
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
 
     // --- Accessors ---
-    CellType at(int r, int c) const { return (CellType)grid[r][c]; }
-    void set(int r, int c, CellType t) { grid[r][c] = (int)t; }
+    CellType at(int r, int c) const {
+        return (CellType)((types[typeByte(r, c)] >> ((c & 1) * 4)) & 0xF);
+    }
+    void set(int r, int c, CellType t);
+
+    // --- Capability flags (precomputed per cell, no bounds checks) ---
+    bool blocksMovement(int r, int c) const { return moveBlock.test(r, c); }
+    bool blocksVision(int r, int c) const { return visionBlock.test(r, c); }
+    bool blocksFire(int r, int c) const { return fireBlock.test(r, c); }
+
+    const Bitboard& moveBlockers() const { return moveBlock; }
+    const Bitboard& visionBlockers() const { return visionBlock; }
+    const Bitboard& fireBlockers() const { return fireBlock; }
+    TerrainBits terrainBits() const;
+
+    // Changes whenever movement blocking does; unique across maps, so
+    // path caches can key on it alone
+    uint32_t terrainVersion() const { return version; }
+
+    // --- Grid kernels specialised for this map's shape (chosen at construction) ---
+    const GridKernels& kernels() const { return *kernelSet; }
+
+    // --- Team bases (derived from the map size) ---
+    // Orange holds the low corner, Blue the opposite one.
+    Vec2i medStorage(TeamColor t) const;
+    Vec2i ammoStorage(TeamColor t) const;
+    Vec2i rallyCorner(TeamColor t, int inset) const; // cell 'inset' in from the team's corner
+    Vec2i clampCell(int r, int c) const;             // nearest in-bounds cell
 
     // --- Visibility ---
     bool hasLineOfSight(const Vec2i& a, const Vec2i& b) const; // true if no blocking tiles between a and b
 
+    // --- Connectivity ---
+    // Connected components of movable cells (4-neighbour, as A* moves).
+    // Labels are rebuilt on the first query after a terrain change, so
+    // a query is O(1) otherwise.
+    int componentOf(int r, int c) const;                    // -1 for blocked cells
+    bool connected(const Vec2i& from, const Vec2i& to) const; // true if A* could join them
+    int componentSize(int label) const;                     // cells carrying 'label'
+
 private:
-    int grid[MSZ][MSZ];
+    // Terrain: 4-bit CellType per cell (two per byte, row-major),
+    // plus one bitboard per capability
+    int nRows;
+    int nCols;
+    int bytesPerRow;
+    std::vector<uint8_t, CacheAlignedAllocator<uint8_t>> types;
+    Bitboard moveBlock;   // ROCK, WATER
+    Bitboard visionBlock; // ROCK, TREE
+    Bitboard fireBlock;   // ROCK, TREE
+    uint32_t version;
+    void bumpVersion();
+
+    const GridKernels* kernelSet;
+
+    // Component labels (lazy; see componentOf)
+    mutable Grid<int> components;
+    mutable std::vector<int> componentCells; // cells per label
+    mutable bool componentsDirty = true;
+    void labelComponents() const;
+
+    size_t typeByte(int r, int c) const { return size_t(r) * bytesPerRow + (c >> 1); }
 
     // Internal drawing helper
     void drawCell(int r, int c) const;
@@ -7,6 +7,8 @@
 #include "SafetyMap.h"
 #include "Commander.h"
 #include "Warrior.h"
+#include "TeamRoster.h"
+#include "EventScheduler.h"
 #include <cstdio>
 #include <algorithm>
 
@@ -18,18 +20,20 @@ extern std::vector<Agent*> gTeamBlue;
 extern SafetyMap* gDangerOrange;
 extern SafetyMap* gDangerBlue;
 extern Map* gWorldForStates;
+extern TeamRoster* gRosterOrange;
+extern TeamRoster* gRosterBlue;
 
 // ------------------------------------------------------------
 // Utility
 // ------------------------------------------------------------
 static inline bool inWorld(int r, int c) {
-    return (r >= 0 && r < MSZ && c >= 0 && c < MSZ);
+    return gWorldForStates && gWorldForStates->inBounds(r, c);
 }
 
 // ------------------------------------------------------------
 // Constructor
 // ------------------------------------------------------------
-Medic::Medic(TeamColor t, int r, int c) : Agent(t, r, c) {
+Medic::Medic(TeamColor t, int r, int c) : Agent(t, ROLE_MEDIC, r, c) {
     homePos = { r, c };
 }
 
@@ -42,47 +46,109 @@ std::vector<Agent*>& Medic::myTeamVec() {
 
 // ------------------------------------------------------------
 // Select closest dead teammate (for commander order)
+// Closest by walking distance: one multi-goal search over every
+// fallen teammate, so a body behind a wall is never chosen.
 // ------------------------------------------------------------
 Agent* Medic::pickWoundedTarget(const Order& o) {
-    auto& team = myTeamVec();
-    Agent* best = nullptr;
-    int bestD = 1e9;
-
+    if (!gWorldForStates) return nullptr;
     Vec2i anchor = (o.targetRow >= 0 && o.targetCol >= 0)
         ? Vec2i{ o.targetRow, o.targetCol }
     : this->getPos();
 
-    for (auto* a : team) {
-        if (a == this) continue;
-        if (!a->isAlive() && a->getHP() <= 0.0) {
-            int d = std::abs(a->row() - anchor.r) + std::abs(a->col() - anchor.c);
-            if (d < bestD) { bestD = d; best = a; }
+    std::vector<Agent*> fallen;
+    std::vector<Vec2i> goals;
+    for (auto* a : myTeamVec()) {
+        if (a != this && !a->isAlive() && a->getHP() <= 0.0) {
+            fallen.push_back(a);
+            goals.push_back(a->getPos());
         }
     }
-    return best;
+
+    // A single candidate needs no search, only its component
+    if (goals.size() == 1)
+        return gWorldForStates->connected(anchor, goals[0]) ? fallen[0] : nullptr;
+
+    std::vector<Vec2i> path;
+    int k = Pathfinder::AStarNearest(*gWorldForStates, anchor, goals, path);
+    return (k < 0) ? nullptr : fallen[k];
 }
 
 // ------------------------------------------------------------
 // Path planning using A* with optional danger map
 // ------------------------------------------------------------
+const SafetyMap* Medic::teamDanger() const {
+    return (getTeam() == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
+}
+
 bool Medic::planPathTo(Map& world, const Vec2i& goal) {
     if (!inWorld(goal.r, goal.c)) return false;
+    // Walled-off goal: fail before any search runs
+    if (!world.connected(getPos(), goal)) return false;
 
     std::vector<Vec2i> path;
-    const SafetyMap* sm = (getTeam() == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
-    const int (*danger)[MSZ] = sm ? sm->getGridPtr() : nullptr;
+    const SafetyMap* danger = teamDanger();
 
+    // Danger only re-weights steps, so a danger-free retry would fail
+    // exactly when this search does
     bool ok = Pathfinder::AStar(world, getPos(), goal, path, danger);
-    if (!ok || path.empty()) {
-        ok = Pathfinder::AStar(world, getPos(), goal, path, nullptr);
-        if (!ok || path.empty()) return false;
-    }
+    if (!ok || path.empty()) return false;
+
+    setPath(path);
+    setTarget(goal);
+    return true;
+}
+
+// ------------------------------------------------------------
+// Same, toward whichever goal is cheapest to reach (one search).
+// Returns its index in 'goals', or -1.
+// ------------------------------------------------------------
+int Medic::planPathToNearest(Map& world, const std::vector<Vec2i>& goals) {
+    std::vector<Vec2i> path;
+    int k = Pathfinder::AStarNearest(world, getPos(), goals, path, teamDanger());
+    if (k < 0 || path.empty()) return -1;
 
     setPath(path);
+    setTarget(goals[k]);
+    return k;
+}
+
+// ------------------------------------------------------------
+// Mission route
+// Set up once per mission: the home -> storage and storage -> home
+// legs come from the shared static-leg cache, the soldier legs are
+// searched when walked (again only if the soldier moved or the
+// medic left the route).
+// ------------------------------------------------------------
+bool Medic::planMission(Map& world) {
+    if (!inWorld(medStorage.r, medStorage.c) || !inWorld(soldierTarget.r, soldierTarget.c)) return false;
+
+    const Vec2i& p = getPos();
+    const bool atHome = (p.r == homePos.r && p.c == homePos.c);
+    std::vector<RouteStop> stops = { { medStorage, true }, { soldierTarget, false }, { homePos, true } };
+    if (!route.plan(world, p, atHome, stops)) return false;
+    return walkLeg(world, LEG_STORAGE, medStorage);
+}
+
+// Sets the path of route leg 'leg' toward 'goal' (false if empty / unreachable)
+bool Medic::walkLeg(Map& world, int leg, const Vec2i& goal) {
+    if (leg >= route.legCount()) return planPathTo(world, goal); // no route for this leg
+
+    const std::vector<Vec2i>* path = route.walk(world, leg, getPos(), goal, teamDanger());
+    if (!path || path->empty()) return false;
+    setPath(*path);
     setTarget(goal);
     return true;
 }
 
+// Storage -> home without a soldier leg: a one-leg route, so a static cached leg
+bool Medic::walkHomeFromStorage(Map& world) {
+    const Vec2i& p = getPos();
+    const bool atStorage = (p.r == medStorage.r && p.c == medStorage.c);
+    std::vector<RouteStop> stops(1, RouteStop{ homePos, true });
+    if (!route.plan(world, p, atStorage, stops)) return false;
+    return walkLeg(world, 0, homePos);
+}
+
 // ------------------------------------------------------------
 // Receive commander order (HEAL logic)
 // ------------------------------------------------------------
@@ -95,14 +161,14 @@ void Medic::receiveOrder(const Order& o) {
     if (o.targetRow < 0 || o.targetCol < 0) {
         /*std::printf("Medic (%s): invalid order target.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     if (!inWorld(medStorage.r, medStorage.c)) {
         /*std::printf("Medic (%s): medStorage invalid.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
@@ -110,21 +176,21 @@ void Medic::receiveOrder(const Order& o) {
     if (!patientPtr || patientPtr->isAlive()) {
         /*std::printf("Medic (%s): no valid dead soldier found.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     soldierTarget = patientPtr->getPos();
 
-    if (!gWorldForStates || !planPathTo(*gWorldForStates, medStorage)) {
+    if (!gWorldForStates || !planMission(*gWorldForStates)) {
        /* std::printf("Medic (%s): path to storage failed.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     onReturn = false;
-    setState(new MoveToTarget());
+    setState(MoveToTarget::instance());
     moving = true;
 
     /*std::printf("Medic (%s): moving to storage (%d,%d) → then revive (%d,%d)\n",
@@ -137,26 +203,23 @@ void Medic::receiveOrder(const Order& o) {
 // ------------------------------------------------------------
 void Medic::onReachedStorage() {
     if (!patientPtr || patientPtr->isAlive()) {
-        // look for wounded teammate
-        auto& teamVec = myTeamVec();
-        Agent* wounded = nullptr;
-        int bestDist = 1e9;
-
-        for (auto* a : teamVec) {
-            if (a == this) continue;
-            if (a->isAlive() && a->getHP() < 50.0) {
-                int d = std::abs(a->row() - row()) + std::abs(a->col() - col());
-                if (d < bestDist) { bestDist = d; wounded = a; }
+        // look for the wounded teammate with the cheapest route
+        std::vector<Agent*> wounded;
+        std::vector<Vec2i> goals;
+        for (auto* a : myTeamVec()) {
+            if (a != this && a->isAlive() && a->getHP() < 50.0) {
+                wounded.push_back(a);
+                goals.push_back(a->getPos());
             }
         }
 
-        if (wounded && wounded->isAlive() && wounded->getHP() < 100.0) {
-            patientPtr = wounded;
-            soldierTarget = wounded->getPos();
-
-            if (gWorldForStates && planPathTo(*gWorldForStates, soldierTarget)) {
+        if (!wounded.empty() && gWorldForStates) {
+            int k = planPathToNearest(*gWorldForStates, goals);
+            if (k >= 0) {
+                patientPtr = wounded[k];
+                soldierTarget = goals[k];
                 onReturn = true;
-                setState(new MoveToTarget());
+                setState(MoveToTarget::instance());
                 moving = true;
                 /*printf("🏃 Medic (%s): switching to heal wounded soldier at (%d,%d)\n",
                     (team == TEAM_ORANGE ? "Orange" : "Blue"),
@@ -168,23 +231,23 @@ void Medic::onReachedStorage() {
         // no wounded found → go home
         /*printf("Medic (%s): no wounded to heal → returning home.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        planPathTo(*gWorldForStates, homePos);
-        setState(new MoveToTarget());
+        walkHomeFromStorage(*gWorldForStates);
+        setState(MoveToTarget::instance());
         moving = true;
         onReturn = false;
         return;
     }
 
     soldierTarget = patientPtr->getPos();
-    if (!gWorldForStates || !planPathTo(*gWorldForStates, soldierTarget)) {
+    if (!gWorldForStates || !walkLeg(*gWorldForStates, LEG_SOLDIER, soldierTarget)) {
         /*std::printf("Medic (%s): path storage→patient failed.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     onReturn = true;
-    setState(new MoveToTarget());
+    setState(MoveToTarget::instance());
     moving = true;
 
     /*std::printf("Medic (%s): heading to revive at (%d,%d)\n",
@@ -204,10 +267,6 @@ void Medic::update(Map& world) {
 
     Agent::update(world);
 
-    static int pathRecalcCooldown = 0;
-    if (pathRecalcCooldown > 0) pathRecalcCooldown--;
-
-
     if (pathIndex >= 0) {
         bool walking = advanceAlongPath(world);
         if (walking) return;
@@ -224,10 +283,10 @@ void Medic::update(Map& world) {
                 int drift = std::abs(livePos.r - soldierTarget.r) + std::abs(livePos.c - soldierTarget.c);
                 if (drift >= 2) {
                     soldierTarget = livePos;
-                    if (pathRecalcCooldown == 0 && gWorldForStates && planPathTo(*gWorldForStates, soldierTarget)) {
-                        pathRecalcCooldown = 60;
+                    if (now() >= replanReadyFrame && gWorldForStates && planPathTo(*gWorldForStates, soldierTarget)) {
+                        armTimer(replanReadyFrame, TIMER_REPLAN, 60);
                         setTarget(soldierTarget);
-                        setState(new MoveToTarget());
+                        setState(MoveToTarget::instance());
                         moving = true;
                         return;
                     }
@@ -242,28 +301,27 @@ void Medic::update(Map& world) {
                     soldierTarget.r, soldierTarget.c);*/
             }
 
-            // re-engage after heal
-            auto& teamVec = myTeamVec();
-            for (auto* a : teamVec) {
-                if (auto* cmd = dynamic_cast<Commander*>(a)) {
-                    const Vec2i& p = patientPtr->getPos();
-                    cmd->addOrder(Order(OrderType::ATTACK, p.r, p.c));
-                    /*std::printf("⚔️ Commander %s re-engages healed warrior (%d,%d)\n",
-                        (team == TEAM_ORANGE ? "Orange" : "Blue"), p.r, p.c);*/
-                    break;
-                }
+            // re-engage after heal (the patient may have died or been
+            // healed on the way, which clears patientPtr)
+            const TeamRoster& roster = (getTeam() == TEAM_ORANGE) ? *gRosterOrange : *gRosterBlue;
+            Commander* cmd = roster.commander();
+            if (cmd && patientPtr) {
+                const Vec2i& p = patientPtr->getPos();
+                cmd->addOrder(Order(OrderType::ATTACK, p.r, p.c));
+                /*std::printf("⚔️ Commander %s re-engages healed warrior (%d,%d)\n",
+                    (team == TEAM_ORANGE ? "Orange" : "Blue"), p.r, p.c);*/
             }
 
             // go home
-            if (gWorldForStates && planPathTo(*gWorldForStates, homePos)) {
+            if (gWorldForStates && walkLeg(*gWorldForStates, LEG_HOME, homePos)) {
                 setTarget(homePos);
-                setState(new MoveToTarget());
+                setState(MoveToTarget::instance());
                 moving = true;
             }
             else {
                 /*std::printf("Medic (%s): failed to plan path home.\n",
                     (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-                setState(new Idle());
+                setState(Idle::instance());
             }
 
             onReturn = false;
@@ -283,10 +341,10 @@ void Medic::update(Map& world) {
                     patientPtr = w;
                     soldierTarget = w->getPos();
 
-                    if (pathRecalcCooldown == 0 && gWorldForStates && planPathTo(*gWorldForStates, medStorage)) {
-                        pathRecalcCooldown = 200;
+                    if (now() >= replanReadyFrame && gWorldForStates && planPathTo(*gWorldForStates, medStorage)) {
+                        armTimer(replanReadyFrame, TIMER_REPLAN, 200);
                         onReturn = false;
-                        setState(new MoveToTarget());
+                        setState(MoveToTarget::instance());
                         moving = true;
                         onReachedStorage();
                     }
@@ -300,49 +358,58 @@ void Medic::update(Map& world) {
     // 🧠 Only act if commander didn't give an order
     if (!isMoving() && !patientPtr) {
         TeamColor team = getTeam();
-        auto& teamVec = (team == TEAM_ORANGE) ? gTeamOrange : gTeamBlue;
+        const TeamRoster& roster = (team == TEAM_ORANGE) ? *gRosterOrange : *gRosterBlue;
 
         // 🏥 Base (medical storage) per team
-        Vec2i baseStorage = (team == TEAM_ORANGE)
-            ? Vec2i{ 6, 9 }
-        : Vec2i{ MSZ - 7, MSZ - 10 };
-
-        for (auto* a : teamVec) {
-            if (auto* w = dynamic_cast<Warrior*>(a)) {
-                if (w->isAlive() && w->getHP() < 50.0) {
+        Vec2i baseStorage = gWorldForStates->ammoStorage(team);
 
-                    // ⚖️ Calculate distance between wounded and base
-                    int distToBase = std::abs(w->row() - baseStorage.r) +
-                        std::abs(w->col() - baseStorage.c);
+        for (auto* w : roster.warriors()) {
+            if (w->isAlive() && w->getHP() < 50.0) {
 
-                    // 📏 Only start moving if soldier is near base (radius ≤ 5)
-                    if (distToBase <= 3) {
-                        patientPtr = w;
-                        soldierTarget = w->getPos();
+                // ⚖️ Calculate distance between wounded and base
+                int distToBase = std::abs(w->row() - baseStorage.r) +
+                    std::abs(w->col() - baseStorage.c);
 
-                        // 🏃 Step 1: go to medical storage first
-                        if (gWorldForStates && planPathTo(*gWorldForStates, medStorage)) {
-                            onReturn = false;
-                            setState(new MoveToTarget());
-                            moving = true;
+                // 📏 Only start moving if soldier is near base (radius ≤ 5)
+                if (distToBase <= 3) {
+                    patientPtr = w;
+                    soldierTarget = w->getPos();
 
-                            /*std::printf("💊 Medic (%s): soldier near base (dist=%d) → going to med storage first\n",
-                                team == TEAM_ORANGE ? "Orange" : "Blue", distToBase);*/
-                        }
+                    // 🏃 Step 1: go to medical storage first
+                    if (gWorldForStates && planMission(*gWorldForStates)) {
+                        onReturn = false;
+                        setState(MoveToTarget::instance());
+                        moving = true;
 
-                        // 🔄 Step 2: once reaches storage, onReachedStorage() will handle moving to patient
-                        // (it already calls planPathTo(soldierTarget))
-                    }
-                    else {
-                        /*std::printf("⏳ Medic (%s): soldier too far (dist=%d) → waiting near base\n",
+                        /*std::printf("💊 Medic (%s): soldier near base (dist=%d) → going to med storage first\n",
                             team == TEAM_ORANGE ? "Orange" : "Blue", distToBase);*/
                     }
 
-                    break; // only handle one wounded soldier at a time
+                    // 🔄 Step 2: once reaches storage, onReachedStorage() will handle moving to patient
+                    // (it walks the route's soldier leg)
                 }
+                else {
+                    /*std::printf("⏳ Medic (%s): soldier too far (dist=%d) → waiting near base\n",
+                        team == TEAM_ORANGE ? "Orange" : "Blue", distToBase);*/
+                }
+
+                break; // only handle one wounded soldier at a time
             }
         }
     }
 
 
 }
+
+// ------------------------------------------------------------
+// Event scheduling
+// ------------------------------------------------------------
+void Medic::hashState(StateHash& h) const {
+    Agent::hashState(h);
+    h.add(medStorage);
+    h.add(soldierTarget);
+    h.add(homePos);
+    h.add(int64_t(onReturn));
+    h.add(patientPtr);
+    h.add(int64_t(replanReadyFrame));
+}
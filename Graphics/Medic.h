@@ -2,6 +2,7 @@
 #include "Agent.h"
 #include "Order.h"
 #include "Types.h"
+#include "Pathfinder.h"
 #include <vector>
 
 // Forward declarations
@@ -23,6 +24,9 @@ public:
     void receiveOrder(const Order& o) override;
     void onReachedStorage();
 
+    // --- Event scheduling ---
+    void hashState(StateHash& h) const override;
+
     // --- Key positions ---
     Vec2i medStorage{ -1, -1 };     // team medical warehouse
     Vec2i soldierTarget{ -1, -1 };  // target (fallen soldier)
@@ -31,9 +35,19 @@ public:
 
 private:
     Agent* patientPtr = nullptr;    // reference to soldier being revived
+    int replanReadyFrame = 0;       // match frame from which re-planning is allowed again
+
+    // --- Mission route: storage -> soldier -> home ---
+    enum { LEG_STORAGE, LEG_SOLDIER, LEG_HOME };
+    Route route;
 
     // --- Internal helpers ---
     bool planPathTo(Map& world, const Vec2i& goal);
+    int planPathToNearest(Map& world, const std::vector<Vec2i>& goals);
+    bool planMission(Map& world);
+    bool walkLeg(Map& world, int leg, const Vec2i& goal);
+    bool walkHomeFromStorage(Map& world);
+    const SafetyMap* teamDanger() const;
     Agent* pickWoundedTarget(const Order& o);
     std::vector<Agent*>& myTeamVec();
     std::vector<Agent*>& enemyTeamVec();
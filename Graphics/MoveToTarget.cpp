@@ -6,53 +6,118 @@
 #include "Pathfinder.h"
 #include "Types.h"
 #include "SafetyMap.h"
+#include "Reservations.h"
+#include "TimingWheel.h"
 #include "Medic.h"
 #include "Provider.h"
+#include <algorithm>
+
+// ============================================================
+// Shared instance (the state holds no per-agent data)
+// ============================================================
+MoveToTarget* MoveToTarget::instance() {
+    static MoveToTarget s;
+    return &s;
+}
 
 // ============================================================
 // OnEnter - calculate A* path to target
+// Medics and Providers arrive with a planned route leg; it is kept
+// when it still starts here and ends at the target. A search longer
+// than PATH_NODE_BUDGET nodes goes on in Transition, one budget per
+// tick; meanwhile the agent walks toward the closest cell found.
+// Warriors of a group order walk the squad's flow field instead
+// (see Commander::dispatchOrders).
 // ============================================================
+static bool hasLegToTarget(const Agent* a) {
+    if (a->getRole() != ROLE_MEDIC && a->getRole() != ROLE_PROVIDER) return false;
+    const std::vector<Vec2i>& path = a->getPath();
+    const Vec2i& goal = a->getTarget();
+    return a->getPathIndex() == 0 && !path.empty()
+        && path.back().r == goal.r && path.back().c == goal.c;
+}
+
+// Use danger map only for combat units (not Medic or Provider)
+static const SafetyMap* dangerFor(const Agent* a) {
+    if (a->getRole() == ROLE_MEDIC || a->getRole() == ROLE_PROVIDER) return nullptr;
+    return (a->getTeam() == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
+}
+
 void MoveToTarget::OnEnter(Agent* a) {
+    if (hasLegToTarget(a)) return;
+
     std::vector<Vec2i> path;
     Vec2i start = a->getPos();
     Vec2i goal = a->getTarget();
 
-    const int (*dangerGrid)[MSZ] = nullptr;
-
-    // Use danger map only for combat units (not Medic or Provider)
-    if (!dynamic_cast<Medic*>(a) && !dynamic_cast<Provider*>(a)) {
-        if (a->getTeam() == TEAM_ORANGE && gDangerOrange)
-            dangerGrid = gDangerOrange->getGridPtr();
-        else if (a->getTeam() == TEAM_BLUE && gDangerBlue)
-            dangerGrid = gDangerBlue->getGridPtr();
-    }
+    const SafetyMap* danger = dangerFor(a);
 
     // Attempt to plan a safe path
-    if (Pathfinder::AStar(*gWorldForStates, start, goal, path, dangerGrid))
+    PathSearch& search = a->pathSearch();
+    PathSearch::Status status = search.begin(*gWorldForStates, start, goal, danger, PATH_NODE_BUDGET);
+    if (status == PathSearch::SEARCH_RUNNING)
+        status = search.step(PATH_NODE_BUDGET);
+
+    const bool routed = status != PathSearch::SEARCH_FAILED && search.routeFrom(start, path);
+    if (!search.running()) search.cancel();
+    if (routed)
         a->setPath(path);
     else {
         a->setPath({});
-        a->setState(new Idle());
+        a->setState(Idle::instance());
+    }
+}
+
+// Polls a running search. False while the agent has to wait for it
+// (nothing found to walk yet); the Idle switch is made here on failure.
+static bool pollSearch(Agent* a) {
+    PathSearch& search = a->pathSearch();
+    PathSearch::Status status = search.step(PATH_NODE_BUDGET);
+    std::vector<Vec2i> path;
+
+    if (status == PathSearch::SEARCH_FAILED) {
+        a->setPath({});
+        a->setState(Idle::instance());
+        return false;
+    }
+
+    const bool found = (status == PathSearch::SEARCH_FOUND);
+    const bool walking = a->getPathIndex() >= 0 && a->getPathIndex() < (int)a->getPath().size();
+    if (!found && walking) return true;
+
+    // The agent only walked tree routes, so it stands on the tree unless
+    // a terrain change restarted the search; then it plans afresh
+    if (search.routeFrom(a->getPos(), path) && (found || !path.empty())) {
+        if (found) search.cancel();
+        a->setPath(path);
+        return true;
     }
+    if (found) a->setState(MoveToTarget::instance());
+    return false;
 }
 
 // ============================================================
 // Transition - move along path; handle completion
 // ============================================================
 void MoveToTarget::Transition(Agent* a) {
-    // Continue moving until path ends
+    if (a->pathSearch().running() && !pollSearch(a)) return;
+
+    // Continue moving until path ends (a partial route ending is not arrival)
     if (!a->advanceAlongPath(*gWorldForStates)) {
+        if (a->pathSearch().running()) return;
         OnExit(a);
 
         // --- Special behaviors ---
-        if (auto* m = dynamic_cast<Medic*>(a)) {
+        if (a->getRole() == ROLE_MEDIC) {
+            auto* m = static_cast<Medic*>(a);
             if (!m->onReturn) {
                 m->onReachedStorage();
                 return;
             }
         }
 
-        if (auto* p = dynamic_cast<Provider*>(a)) {
+        if (a->getRole() == ROLE_PROVIDER) {
+            auto* p = static_cast<Provider*>(a);
             if (!p->onReturn) {
                 p->onReachedStorage();
                 return;
@@ -60,13 +125,55 @@ void MoveToTarget::Transition(Agent* a) {
         }
 
         // Default: return to Idle
-        a->setState(new Idle());
+        a->setState(Idle::instance());
     }
 }
 
 // ============================================================
-// OnExit - cleanup (currently unused)
+// OnExit - drop a search still in progress
+// ============================================================
+void MoveToTarget::OnExit(Agent* a) {
+    a->pathSearch().cancel();
+}
+
 // ============================================================
-void MoveToTarget::OnExit(Agent* /*a*/) {
-    // No cleanup required for this state
+// Cooperative windows (WHCA*)
+// Warriors moving in squads reserve their next COOP_WINDOW steps
+// in the team's table, and each plans around the ones planned
+// before it. A warrior re-plans once half its window is walked
+// and the path goes on past it. A warrior that is not moving is
+// parked on its cell, so the others route around it. Medics and
+// Providers walk shared route legs and are not reserved.
+// ============================================================
+void MoveToTarget::planWindows(const std::vector<Agent*>& team, ReservationTable& table) {
+    const int now = gTimingWheel->now();
+
+    for (Agent* a : team) {
+        if (a->getRole() != ROLE_WARRIOR) continue;
+        if (!a->isAlive()) {
+            table.release(a->getId());
+            continue;
+        }
+
+        const std::vector<Vec2i>& path = a->getPath();
+        const int left = (a->getPathIndex() < 0) ? 0 : (int)path.size() - a->getPathIndex();
+        if (a->getState() != instance() || left <= 0) {
+            if (table.parkedOn(a->getId(), a->getPos())) continue;
+            table.release(a->getId());
+            if (table.isFree(a->getPos(), now, ReservationTable::FOREVER, a->getId()))
+                table.reserve(a->getId(), a->getPos(), now, ReservationTable::FOREVER);
+            continue;
+        }
+        if (a->pathSearch().running()) continue;
+        if (a->reservedSteps() > COOP_WINDOW / 2 || a->reservedSteps() >= left) continue;
+
+        const StepClock clock{ now, std::max(now, a->nextStepAt()), Agent::stepPeriod() };
+        std::vector<Vec2i> planned;
+        int reserved = 0;
+        if (Pathfinder::AStarWindow(*gWorldForStates, table, a->getId(), clock, a->getPos(), path.back(),
+                COOP_WINDOW, planned, reserved, dangerFor(a))) {
+            a->setPath(planned);
+            a->setReservedSteps(reserved);
+        }
+    }
 }
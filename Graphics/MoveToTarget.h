@@ -1,5 +1,8 @@
 #pragma once
 #include "State.h"
+#include <vector>
+
+class ReservationTable;
 
 // ============================================================
 // MoveToTarget State
@@ -8,7 +11,14 @@
 // ============================================================
 class MoveToTarget : public State {
 public:
+    static MoveToTarget* instance(); // shared flyweight
+
     void OnEnter(Agent* a) override;
     void Transition(Agent* a) override;
     void OnExit(Agent* a) override;
+
+    // Once per tick, before agents move: re-plans the cooperative
+    // window of each of 'team's warriors that is running out of
+    // reserved steps, in team order, against the team's 'table'
+    static void planWindows(const std::vector<Agent*>& team, ReservationTable& table);
 };
@@ -0,0 +1,78 @@
+#include "OrderQueue.h"
+#include "EventScheduler.h"
+
+// Slot order doubles as dispatch priority
+enum OrderSlot : int {
+    SLOT_HEAL = 0,     // Medic
+    SLOT_RESUPPLY = 1, // Provider
+    SLOT_COMBAT = 2    // Warriors (ATTACK / DEFEND / MOVE)
+};
+
+// ============================================================
+// Key mapping
+// ============================================================
+AgentRole OrderQueue::executorOf(OrderType t) {
+    switch (t) {
+    case OrderType::HEAL:     return ROLE_MEDIC;
+    case OrderType::RESUPPLY: return ROLE_PROVIDER;
+    default:                  return ROLE_WARRIOR;
+    }
+}
+
+int OrderQueue::slotOf(OrderType t) {
+    switch (executorOf(t)) {
+    case ROLE_MEDIC:    return SLOT_HEAL;
+    case ROLE_PROVIDER: return SLOT_RESUPPLY;
+    default:            return SLOT_COMBAT;
+    }
+}
+
+// ============================================================
+// Queue operations
+// ============================================================
+void OrderQueue::push(const Order& o) {
+    if (o.type == OrderType::NONE) return;
+
+    int s = slotOf(o.type);
+    if (!pending[s]) {
+        pending[s] = true;
+        count++;
+    }
+    slots[s] = o; // newest order for this role wins
+}
+
+bool OrderQueue::pop(Order& out) {
+    for (int s = 0; s < CAPACITY; ++s) {
+        if (!pending[s]) continue;
+        out = slots[s];
+        pending[s] = false;
+        count--;
+        return true;
+    }
+    return false;
+}
+
+int OrderQueue::popBatch(Order* out, int maxCount) {
+    int n = 0;
+    while (n < maxCount && pop(out[n])) ++n;
+    return n;
+}
+
+void OrderQueue::clear() {
+    for (int s = 0; s < CAPACITY; ++s) pending[s] = false;
+    count = 0;
+}
+
+bool OrderQueue::hasPending(OrderType t) const {
+    int s = slotOf(t);
+    return pending[s] && slots[s].type == t;
+}
+
+void OrderQueue::hashState(StateHash& h) const {
+    for (int s = 0; s < CAPACITY; ++s) {
+        h.add(int64_t(pending[s]));
+        if (!pending[s]) continue;
+        h.add(int64_t(slots[s].type));
+        h.add(Vec2i{ slots[s].targetRow, slots[s].targetCol });
+    }
+}
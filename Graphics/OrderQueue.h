@@ -0,0 +1,43 @@
+#pragma once
+#include "Order.h"
+#include "Definitions.h"
+
+class StateHash;
+
+// ============================================================
+// OrderQueue
+// Fixed-capacity, coalescing priority queue of commander orders.
+// Each order is keyed by its type and the role that executes it:
+//   HEAL -> Medic, RESUPPLY -> Provider, ATTACK/DEFEND/MOVE -> Warrior
+// One slot per executing role: a newer order replaces any pending
+// order for the same role (a fresh ATTACK supersedes a stale DEFEND),
+// so memory and dispatch cost stay bounded however long the battle
+// runs. Slots drain in priority order HEAL > RESUPPLY > combat.
+// ============================================================
+class OrderQueue {
+public:
+    static const int CAPACITY = 3; // one slot per executing role
+
+    // Role that carries out an order of this type
+    static AgentRole executorOf(OrderType t);
+
+    // --- Queue operations ---
+    void push(const Order& o);              // insert or coalesce
+    bool pop(Order& out);                   // highest-priority pending order
+    int popBatch(Order* out, int maxCount); // drain up to maxCount, by priority
+    void clear();
+
+    // --- Queries (all O(1)) ---
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+    bool hasPending(OrderType t) const;
+
+    void hashState(StateHash& h) const; // pending slots (for EventScheduler)
+
+private:
+    static int slotOf(OrderType t);
+
+    Order slots[CAPACITY];
+    bool pending[CAPACITY] = { false, false, false };
+    int count = 0;
+};
@@ -0,0 +1,78 @@
+#include "PathCache.h"
+#include <cstddef>
+
+static inline bool samePos(const Vec2i& a, const Vec2i& b) {
+    return a.r == b.r && a.c == b.c;
+}
+
+// ============================================================
+// Lookup
+// ============================================================
+bool PathCache::lookup(const Vec2i& start, const Vec2i& goal, uint32_t terrain, uint32_t danger,
+    std::vector<Vec2i>& out)
+{
+    Entry* exact = nullptr;
+    Entry* covering = nullptr;
+    size_t coverAt = 0;
+
+    for (Entry& e : entries) {
+        if (e.terrain != terrain || e.danger != danger || !samePos(e.goal, goal)) continue;
+        if (samePos(e.start, start)) { exact = &e; break; }
+
+        // Subpath: start somewhere on this path (not its goal end)
+        if (!covering) {
+            for (size_t i = 0; i + 1 < e.path.size(); ++i) {
+                if (samePos(e.path[i], start)) {
+                    covering = &e;
+                    coverAt = i + 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (exact) {
+        exact->lastUse = ++useClock;
+        out = exact->path;
+        ++counters.hits;
+        return true;
+    }
+    if (covering) {
+        covering->lastUse = ++useClock;
+        out.assign(covering->path.begin() + coverAt, covering->path.end());
+        ++counters.subpathHits;
+        return true;
+    }
+    ++counters.misses;
+    return false;
+}
+
+// ============================================================
+// Store
+// ============================================================
+void PathCache::store(const Vec2i& start, const Vec2i& goal, uint32_t terrain, uint32_t danger,
+    const std::vector<Vec2i>& path)
+{
+    Entry* slot = nullptr;
+    if ((int)entries.size() < CAPACITY) {
+        entries.push_back(Entry());
+        slot = &entries.back();
+    }
+    else {
+        slot = &entries[0];
+        for (Entry& e : entries)
+            if (e.lastUse < slot->lastUse) slot = &e;
+    }
+
+    slot->start = start;
+    slot->goal = goal;
+    slot->terrain = terrain;
+    slot->danger = danger;
+    slot->lastUse = ++useClock;
+    slot->path = path; // reuses the evicted entry's capacity
+}
+
+void PathCache::clear() {
+    entries.clear();
+    useClock = 0;
+}
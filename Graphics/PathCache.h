@@ -0,0 +1,49 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <cstdint>
+
+// ============================================================
+// PathCache
+// Small LRU of A* results keyed by start cell, goal cell and the
+// versions of the costs they were found under (Map::terrainVersion
+// and SafetyMap::version, 0 for danger-free searches). Besides
+// exact repeats it answers "start lies on a path already found to
+// this goal": the rest of an optimal path is itself optimal, so a
+// warrior that re-plans toward the same goal each step reuses the
+// path it is walking instead of searching again.
+// ============================================================
+struct PathCacheStats {
+    long long hits = 0;         // exact (start, goal) repeats
+    long long subpathHits = 0;  // start found on a cached path
+    long long misses = 0;       // searched
+};
+
+class PathCache {
+public:
+    static const int CAPACITY = 128; // entries (paths of any length)
+
+    // Fills 'out' (cells after 'start', up to 'goal') on a hit
+    bool lookup(const Vec2i& start, const Vec2i& goal, uint32_t terrain, uint32_t danger,
+        std::vector<Vec2i>& out);
+
+    // Remembers a successful search (evicts the least recently used entry)
+    void store(const Vec2i& start, const Vec2i& goal, uint32_t terrain, uint32_t danger,
+        const std::vector<Vec2i>& path);
+
+    void clear();
+    const PathCacheStats& stats() const { return counters; }
+
+private:
+    struct Entry {
+        Vec2i start, goal;
+        uint32_t terrain = 0;
+        uint32_t danger = 0;
+        uint64_t lastUse = 0;
+        std::vector<Vec2i> path;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t useClock = 0;
+    PathCacheStats counters;
+};
@@ -22,6 +22,6 @@ struct PathNode {
 // Comparator for priority queue (min-heap by f)
 struct ComparePathNode {
     bool operator()(const PathNode& a, const PathNode& b) const {
-        return a.f > b.f;
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
     }
 };
@@ -1,114 +1,650 @@
 #include "Pathfinder.h"
 #include "Map.h"
-#include "Definitions.h"
+#include "SafetyMap.h"
+#include "Landmarks.h"
+#include "Reservations.h"
+#include <algorithm>
+#include <cstdlib>
 #include <queue>
-#include <cstring>
-#include <cmath>
-#include <algorithm> // for std::reverse
+#include <unordered_map>
+#include <unordered_set>
 
-// ============================================================
-// Utility helpers
-// ============================================================
-
-// Clamp for older C++ versions
-template <typename T>
-inline T clampValue(T v, T lo, T hi) {
-    if (v < lo) return lo;
-    if (v > hi) return hi;
-    return v;
-}
+static PathCache gPathCache;
+static Landmarks gLandmarks; // ALT tables of the current map
+static FirstMoveTable gFirstMoves;
+static long long gFirstMoveWalks = 0;
+static std::vector<FlowField> gSquadFields(SQUAD_FIELDS);
+static size_t gNextSquadField = 0; // slot the next new goal replaces
+static long long gFieldWalks = 0;
 
-// Manhattan distance heuristic
-static inline int manh(const Vec2i& a, const Vec2i& b) {
-    return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+// A walk of a squad field built for this goal under these costs
+static bool walkSquadField(const Map& world, const Vec2i& start, const Vec2i& goal,
+    const SafetyMap* danger, std::vector<Vec2i>& outPath)
+{
+    for (const FlowField& f : gSquadFields)
+        if (f.matches(world, goal, danger) && f.walk(start, outPath)) {
+            ++gFieldWalks;
+            return true;
+        }
+    return false;
 }
 
 // ============================================================
 // A* Implementation
+// The search itself is a grid kernel (GridKernels.cpp), so the
+// map's shape-specialised instantiation runs here. A failing A*
+// expands the whole component before giving up, so the map's
+// component labels are asked first (O(1)). Agents re-plan toward
+// the same goal while walking, so most remaining queries start on
+// a path found a few ticks earlier and come from the cache. Misses
+// search with the map's landmark (ALT) heuristic; danger-free ones
+// at least BIDIRECTIONAL_MIN_DISTANCE apart search from both ends.
+// Queries a squad's flow field covers walk it, and danger-free ones
+// walk the first-move table instead when one was precomputed.
 // ============================================================
 bool Pathfinder::AStar(
     const Map& world,
     const Vec2i& start,
     const Vec2i& goal,
     std::vector<Vec2i>& outPath,
-    const int dangerGrid[MSZ][MSZ]
+    const SafetyMap* danger
+) {
+    if (!world.connected(start, goal)) {
+        outPath.clear();
+        return false;
+    }
+
+    if (walkSquadField(world, start, goal, danger, outPath)) return true;
+
+    if (!danger && gFirstMoves.validFor(world) && gFirstMoves.walk(start, goal, outPath)) {
+        ++gFirstMoveWalks;
+        return true;
+    }
+
+    const uint32_t terrain = world.terrainVersion();
+    const uint32_t dangerVersion = danger ? danger->version() : 0;
+    if (gPathCache.lookup(start, goal, terrain, dangerVersion, outPath)) return true;
+
+    gLandmarks.update(world);
+    const LandmarkView landmarks = gLandmarks.view();
+    const int* dangerCells = danger ? danger->getGrid().data() : nullptr;
+    const bool bidirectional = !danger
+        && std::abs(start.r - goal.r) + std::abs(start.c - goal.c) >= BIDIRECTIONAL_MIN_DISTANCE;
+    const bool ok = bidirectional
+        ? world.kernels().aStarBidirectional(world.terrainBits(), start, goal, outPath, &landmarks)
+        : world.kernels().aStar(world.terrainBits(), start, goal, outPath, dangerCells, &landmarks);
+    if (!ok) return false;
+    gPathCache.store(start, goal, terrain, dangerVersion, outPath);
+    return true;
+}
+
+const PathCacheStats& Pathfinder::cacheStats() {
+    return gPathCache.stats();
+}
+
+FirstMoveTable& Pathfinder::firstMoves() {
+    return gFirstMoves;
+}
+
+long long Pathfinder::firstMoveWalks() {
+    return gFirstMoveWalks;
+}
+
+// Slots are keyed by goal and danger map, so both teams can hold a
+// field to the same cell. A field still current and covering every
+// start is kept; a stale one is rebuilt in its slot.
+void Pathfinder::shareField(const Map& world, const Vec2i& goal,
+    const std::vector<Vec2i>& starts, const SafetyMap* danger)
+{
+    FlowField* slot = nullptr;
+    for (FlowField& f : gSquadFields)
+        if (f.keyedOn(goal, danger)) slot = &f;
+    if (slot && slot->matches(world, goal, danger)
+        && std::all_of(starts.begin(), starts.end(), [slot](const Vec2i& s) { return slot->covers(s); }))
+        return;
+    if (!slot) {
+        slot = &gSquadFields[gNextSquadField];
+        gNextSquadField = (gNextSquadField + 1) % gSquadFields.size();
+    }
+    slot->build(world, goal, starts, danger);
+}
+
+long long Pathfinder::fieldWalks() {
+    return gFieldWalks;
+}
+
+// Goals outside start's component are dropped first, so they neither
+// widen the heuristic nor keep a hopeless search running.
+int Pathfinder::AStarNearest(
+    const Map& world,
+    const Vec2i& start,
+    const std::vector<Vec2i>& goals,
+    std::vector<Vec2i>& outPath,
+    const SafetyMap* danger
 ) {
     outPath.clear();
-    if (start.r == goal.r && start.c == goal.c)
+    std::vector<Vec2i> live;
+    std::vector<int> liveIndex;
+    for (size_t i = 0; i < goals.size(); ++i) {
+        if (!world.connected(start, goals[i])) continue;
+        live.push_back(goals[i]);
+        liveIndex.push_back(int(i));
+    }
+    if (live.empty()) return -1;
+
+    const int* dangerCells = danger ? danger->getGrid().data() : nullptr;
+    int k = world.kernels().aStarNearest(world.terrainBits(), start,
+        live.data(), int(live.size()), outPath, dangerCells);
+    return (k < 0) ? -1 : liveIndex[k];
+}
+
+// ============================================================
+// Route
+// ============================================================
+
+// Fixed-to-fixed legs, keyed by map version. A match has a handful
+// (each support agent's home <-> its storage), so a list will do.
+namespace {
+struct StaticLeg {
+    uint32_t version;
+    Vec2i from, to;
+    bool ok;
+    std::vector<Vec2i> path;
+};
+std::vector<StaticLeg> gStaticLegs;
+}
+
+static bool samePos(const Vec2i& a, const Vec2i& b) {
+    return a.r == b.r && a.c == b.c;
+}
+
+static bool staticLeg(const Map& world, const Vec2i& from, const Vec2i& to, std::vector<Vec2i>& out) {
+    const uint32_t version = world.terrainVersion();
+    for (const StaticLeg& l : gStaticLegs) {
+        if (l.version == version && samePos(l.from, from) && samePos(l.to, to)) {
+            out = l.path;
+            return l.ok;
+        }
+    }
+
+    // Entries of an older map are dead; drop them before adding
+    gStaticLegs.erase(std::remove_if(gStaticLegs.begin(), gStaticLegs.end(),
+        [version](const StaticLeg& l) { return l.version != version; }), gStaticLegs.end());
+
+    StaticLeg l{ version, from, to, false, {} };
+    l.ok = Pathfinder::AStar(world, from, to, l.path, nullptr);
+    gStaticLegs.push_back(l);
+    out = l.path;
+    return l.ok;
+}
+
+bool Route::plan(const Map& world, const Vec2i& start, bool startFixed,
+    const std::vector<RouteStop>& newStops)
+{
+    origin = start;
+    originFixed = startFixed;
+    stops = newStops;
+    legs.assign(stops.size(), Leg());
+
+    for (int i = 0; i < (int)stops.size(); ++i) {
+        const Vec2i from = legStart(i);
+        Leg& leg = legs[i];
+        bool ok;
+        if (legStartFixed(i) && stops[i].fixed) {
+            ok = staticLeg(world, from, stops[i].cell, leg.path);
+            leg.from = from;
+            leg.planned = true;
+        }
+        else {
+            ok = world.connected(from, stops[i].cell);
+        }
+        if (!ok) {
+            clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::vector<Vec2i>* Route::walk(const Map& world, int i, const Vec2i& from,
+    const Vec2i& stop, const SafetyMap* danger)
+{
+    // A dynamic stop that moved stales both legs that touch it
+    if (!samePos(stops[i].cell, stop)) {
+        stops[i].cell = stop;
+        legs[i].planned = false;
+        if (i + 1 < (int)legs.size()) legs[i + 1].planned = false;
+    }
+
+    Leg& leg = legs[i];
+    if (leg.planned && samePos(leg.from, from)) return &leg.path;
+
+    bool ok;
+    if (samePos(from, legStart(i)) && legStartFixed(i) && stops[i].fixed)
+        ok = staticLeg(world, from, stop, leg.path);
+    else
+        ok = Pathfinder::AStar(world, from, stop, leg.path, danger);
+    leg.from = from;
+    leg.planned = ok;
+    return ok ? &leg.path : nullptr;
+}
+
+// ============================================================
+// PathSearch
+// ============================================================
+
+// Per-cell state of one search (key = r * cols + c). g and parent
+// count only where 'reached' holds the current stamp, 'closed' the
+// same, so a slot is reused without clearing.
+struct SearchScratch {
+    std::vector<int> g;
+    std::vector<int> parent;     // key of the parent cell, -1 at the start
+    std::vector<uint32_t> reached;
+    std::vector<uint32_t> closed;
+    uint32_t stamp = 0;
+};
+
+// Slots of finished searches; a match rarely has more than a few in flight
+static std::vector<std::unique_ptr<SearchScratch>> gFreeScratch;
+
+static const int SEARCH_DR[4] = { -1, 1, 0, 0 };
+static const int SEARCH_DC[4] = { 0, 0, -1, 1 };
+
+PathSearch::PathSearch() {}
+
+// Not cancel(): agents outlive the pool at exit
+PathSearch::~PathSearch() {}
+
+int PathSearch::key(const Vec2i& p) const {
+    return p.r * world->cols() + p.c;
+}
+
+Vec2i PathSearch::cellOf(int k) const {
+    return { k / world->cols(), k % world->cols() };
+}
+
+bool PathSearch::closed(int k) const {
+    return scratch->closed[k] == scratch->stamp;
+}
+
+// Same step costs as the A* kernel
+int PathSearch::stepCost(const Vec2i& p) const {
+    return danger ? 1 + std::max(0, std::min(10, danger->get(p.r, p.c) / 10)) : 1;
+}
+
+// Manhattan, tightened by the landmark bounds as in the kernel
+int PathSearch::heuristic(const Vec2i& p) const {
+    const int D = std::abs(p.r - goal.r) + std::abs(p.c - goal.c);
+    if (D == 0 || landmarks.count == 0) return D;
+    const int idx = gridIndex(p.r, p.c, world->cols(), tilesPerRowFor(world->cols()));
+    const int* dp = landmarks.dist + size_t(idx) * landmarks.stride;
+    int best = 0;
+    for (int k = 0; k < landmarks.count; ++k) {
+        if (goalDist[k] < 0 || dp[k] < 0) continue;
+        best = std::max(best, std::abs(goalDist[k] - dp[k]));
+    }
+    return std::max(D, best + lastStep);
+}
+
+PathSearch::Status PathSearch::begin(const Map& w, const Vec2i& s, const Vec2i& g,
+    const SafetyMap* d, int nodeBudget)
+{
+    cancel();
+    world = &w;
+    danger = d;
+    start = s;
+    goal = g;
+
+    if (!w.connected(s, g)) {
+        state = SEARCH_FAILED;
+        return state;
+    }
+
+    if (walkSquadField(w, s, g, d, found)) {
+        state = SEARCH_FOUND;
+        return state;
+    }
+
+    // Answered without a long search: adjacent cells, the first-move
+    // table, a component the budget covers (a blocked start adds its
+    // own expansion), or the cache
+    const bool quick = std::abs(s.r - g.r) + std::abs(s.c - g.c) <= 1
+        || (!d && gFirstMoves.validFor(w))
+        || w.componentSize(w.componentOf(g.r, g.c)) + 1 <= nodeBudget;
+    if (quick) {
+        state = Pathfinder::AStar(w, s, g, found, d) ? SEARCH_FOUND : SEARCH_FAILED;
+        return state;
+    }
+    if (gPathCache.lookup(s, g, w.terrainVersion(), d ? d->version() : 0, found)) {
+        state = SEARCH_FOUND;
+        return state;
+    }
+
+    restart();
+    return state;
+}
+
+void PathSearch::restart() {
+    const size_t cells = size_t(world->rows()) * world->cols();
+    if (!scratch) {
+        if (gFreeScratch.empty()) {
+            scratch.reset(new SearchScratch());
+        }
+        else {
+            scratch = std::move(gFreeScratch.back());
+            gFreeScratch.pop_back();
+        }
+    }
+    if (scratch->g.size() != cells || scratch->stamp == UINT32_MAX) {
+        scratch->g.assign(cells, 0);
+        scratch->parent.assign(cells, -1);
+        scratch->reached.assign(cells, 0);
+        scratch->closed.assign(cells, 0);
+        scratch->stamp = 0;
+    }
+    ++scratch->stamp;
+
+    open.clear();
+    found.clear();
+    terrain = world->terrainVersion();
+    dangerVersion = danger ? danger->version() : 0;
+
+    gLandmarks.update(*world);
+    landmarks = gLandmarks.view();
+    landmarks.count = std::min(landmarks.count, int(LandmarkView::MAX));
+    const int goalIdx = gridIndex(goal.r, goal.c, world->cols(), tilesPerRowFor(world->cols()));
+    for (int k = 0; k < landmarks.count; ++k)
+        goalDist[k] = landmarks.dist[size_t(goalIdx) * landmarks.stride + k];
+    lastStep = stepCost(goal) - 1;
+
+    const int s = key(start);
+    scratch->g[s] = 0;
+    scratch->parent[s] = -1;
+    scratch->reached[s] = scratch->stamp;
+    open.push_back(OpenEntry{ heuristic(start), 0, s });
+    bestKey = s;
+    bestH = heuristic(start);
+    state = SEARCH_RUNNING;
+}
+
+void PathSearch::cancel() {
+    state = SEARCH_IDLE;
+    open.clear();
+    found.clear();
+    bestKey = -1;
+    if (scratch) gFreeScratch.push_back(std::move(scratch));
+}
+
+// Heap order of ComparePathNode: lowest f first, deeper node on ties
+static bool openAfter(int fa, int ga, int fb, int gb) {
+    return fa > fb || (fa == fb && ga < gb);
+}
+
+PathSearch::Status PathSearch::step(int nodeBudget) {
+    if (state != SEARCH_RUNNING) return state;
+    if (world->terrainVersion() != terrain) restart();
+
+    SearchScratch& s = *scratch;
+    const uint32_t stamp = s.stamp;
+    auto after = [](const OpenEntry& a, const OpenEntry& b) { return openAfter(a.f, a.g, b.f, b.g); };
+
+    for (int budget = nodeBudget; budget > 0 && !open.empty(); ) {
+        std::pop_heap(open.begin(), open.end(), after);
+        const OpenEntry cur = open.back();
+        open.pop_back();
+
+        if (s.closed[cur.key] == stamp || cur.g != s.g[cur.key]) continue; // stale entry
+        s.closed[cur.key] = stamp;
+        ++nExpanded;
+        --budget;
+
+        const Vec2i p = cellOf(cur.key);
+        const int h = cur.f - cur.g;
+        if (h < bestH) {
+            bestH = h;
+            bestKey = cur.key;
+        }
+
+        if (p.r == goal.r && p.c == goal.c) {
+            bestKey = cur.key;
+            treeRoute(start, cur.key, found);
+            const uint32_t version = danger ? danger->version() : 0;
+            if (version == dangerVersion)
+                gPathCache.store(start, goal, terrain, dangerVersion, found);
+            open.clear();
+            state = SEARCH_FOUND;
+            return state;
+        }
+
+        for (int k = 0; k < 4; ++k) {
+            const Vec2i q{ p.r + SEARCH_DR[k], p.c + SEARCH_DC[k] };
+            if (!world->inBounds(q.r, q.c) || world->blocksMovement(q.r, q.c)) continue;
+
+            // Closed cells keep their parent, so the tree never changes under a walker
+            const int qk = key(q);
+            const int tentative = cur.g + stepCost(q);
+            if (s.closed[qk] == stamp || (s.reached[qk] == stamp && s.g[qk] <= tentative)) continue;
+
+            s.g[qk] = tentative;
+            s.parent[qk] = cur.key;
+            s.reached[qk] = stamp;
+            open.push_back(OpenEntry{ tentative + heuristic(q), tentative, qk });
+            std::push_heap(open.begin(), open.end(), after);
+        }
+    }
+
+    if (open.empty()) {
+        cancel();
+        state = SEARCH_FAILED;
+    }
+    return state;
+}
+
+// Up the tree from 'from' to the first cell on the start -> 'toKey'
+// branch, then down that branch
+bool PathSearch::treeRoute(const Vec2i& from, int toKey, std::vector<Vec2i>& out) const {
+    out.clear();
+    if (!scratch || !world->inBounds(from.r, from.c) || !closed(key(from))) return false;
+
+    std::vector<int> branch;                 // toKey up to the start
+    std::unordered_map<int, int> onBranch;   // key -> index in 'branch'
+    for (int k = toKey; k >= 0; k = scratch->parent[k]) {
+        onBranch[k] = (int)branch.size();
+        branch.push_back(k);
+    }
+
+    int k = key(from);
+    while (onBranch.find(k) == onBranch.end()) {
+        k = scratch->parent[k];
+        out.push_back(cellOf(k));
+    }
+    for (int i = onBranch[k] - 1; i >= 0; --i)
+        out.push_back(cellOf(branch[i]));
+    return true;
+}
+
+bool PathSearch::routeFrom(const Vec2i& from, std::vector<Vec2i>& out) const {
+    if (state == SEARCH_FOUND && from.r == start.r && from.c == start.c) {
+        out = found;
         return true;
+    }
+    if (bestKey < 0 || (state != SEARCH_RUNNING && state != SEARCH_FOUND)) return false;
+    return treeRoute(from, bestKey, out);
+}
 
-    // Initialize arrays
-    static int  gScore[MSZ][MSZ];
-    static bool closed[MSZ][MSZ];
-    static Vec2i parent[MSZ][MSZ];
+// ============================================================
+// Cooperative windows (WHCA*)
+// The search runs over (cell, step) pairs for steps 0..window.
+// A step moves to a neighbour or waits in place, costed like A*
+// (a wait pays for the cell it stays on). It is legal only if the
+// team's table leaves the cell free for the whole step and no
+// teammate crosses the same edge the other way.
+// The abstract level is the ordinary cached A* path: the search
+// aims for its cell 'window' steps out (the anchor) with a
+// Manhattan heuristic. It ends there, or at the first node that
+// is 'window' steps deep.
+// ============================================================
+namespace {
+struct WindowNode {
+    int f;
+    int g;
+    int t;
+    Vec2i p;
+    int64_t key;
+};
+
+struct CompareWindowNode {
+    bool operator()(const WindowNode& a, const WindowNode& b) const {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+};
+
+struct WindowVisit {
+    int g;
+    int64_t parent; // key of the previous step, -1 at step 0
+    bool closed;
+};
+}
 
-    for (int i = 0; i < MSZ; ++i) {
-        for (int j = 0; j < MSZ; ++j) {
-            gScore[i][j] = 1e9;
-            closed[i][j] = false;
-            parent[i][j] = { -1, -1 };
+static const int WINDOW_DR[5] = { -1, 1, 0, 0, 0 };
+static const int WINDOW_DC[5] = { 0, 0, -1, 1, 0 }; // last: wait
+static const int FAN_OUT_CELLS = 256; // cells tried around a taken goal
+
+static int64_t windowKey(const Vec2i& p, int t) {
+    return (int64_t(t) << 40) | (int64_t(p.r) << 20) | int64_t(p.c);
+}
+
+static Vec2i windowCell(int64_t k) {
+    return { int((k >> 20) & 0xFFFFF), int(k & 0xFFFFF) };
+}
+
+static int manhattan(const Vec2i& a, const Vec2i& b) {
+    return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+}
+
+// Breadth-first from 'goal' to the first cell nobody else is parked
+// on, so a squad sent to one cell spreads around it
+static Vec2i nearestUnparked(const Map& world, const ReservationTable& table, const Vec2i& goal, int agent) {
+    std::vector<Vec2i> queue(1, goal);
+    std::unordered_set<int64_t> seen{ windowKey(goal, 0) };
+    for (size_t i = 0; i < queue.size() && i < (size_t)FAN_OUT_CELLS; ++i) {
+        const Vec2i p = queue[i];
+        if (!table.isParked(p, agent)) return p;
+        for (int d = 0; d < 4; ++d) {
+            Vec2i q{ p.r + WINDOW_DR[d], p.c + WINDOW_DC[d] };
+            if (!world.inBounds(q.r, q.c) || world.blocksMovement(q.r, q.c)) continue;
+            if (seen.insert(windowKey(q, 0)).second) queue.push_back(q);
         }
     }
+    return goal;
+}
 
-    // Check walkable tiles
-    auto passable = [&](int r, int c) -> bool {
-        if (!world.inBounds(r, c)) return false;
-        CellType ct = world.at(r, c);
-        return (ct != ROCK && ct != WATER); // TREE is passable
-        };
+bool Pathfinder::AStarWindow(
+    const Map& world,
+    ReservationTable& table,
+    int agent,
+    const StepClock& clock,
+    const Vec2i& start,
+    const Vec2i& goal,
+    int window,
+    std::vector<Vec2i>& outPath,
+    int& reservedSteps,
+    const SafetyMap* danger
+) {
+    outPath.clear();
+    reservedSteps = 0;
 
-    std::priority_queue<PathNode, std::vector<PathNode>, ComparePathNode> open;
-    gScore[start.r][start.c] = 0;
-    open.push(PathNode(start.r, start.c, 0, manh(start, goal), { -1, -1 }));
+    const Vec2i target = table.isParked(goal, agent) ? nearestUnparked(world, table, goal, agent) : goal;
+    std::vector<Vec2i> spatial;
+    if (!AStar(world, start, target, spatial, danger)) return false;
 
-    static const int dr[4] = { -1, 1, 0, 0 };
-    static const int dc[4] = { 0, 0, -1, 1 };
+    table.release(agent);
+    if (spatial.empty()) {
+        if (table.isFree(start, clock.now, ReservationTable::FOREVER, agent))
+            table.reserve(agent, start, clock.now, ReservationTable::FOREVER);
+        return true;
+    }
+
+    const int depth = std::min(window, (int)spatial.size());
+    const Vec2i anchor = spatial[depth - 1];
+    const bool anchorIsEnd = depth == (int)spatial.size();
+    auto cost = [danger](const Vec2i& p) {
+        return danger ? 1 + std::max(0, std::min(10, danger->get(p.r, p.c) / 10)) : 1;
+    };
 
+    std::priority_queue<WindowNode, std::vector<WindowNode>, CompareWindowNode> open;
+    std::unordered_map<int64_t, WindowVisit> visits;
+    const int64_t startKey = windowKey(start, 0);
+    visits[startKey] = { 0, -1, false };
+    open.push({ manhattan(start, anchor), 0, 0, start, startKey });
+
+    bool ended = false;
+    WindowNode end{};
     while (!open.empty()) {
-        PathNode cur = open.top();
+        const WindowNode cur = open.top();
         open.pop();
+        WindowVisit& visit = visits[cur.key];
+        if (visit.closed) continue;
+        visit.closed = true;
 
-        if (closed[cur.p.r][cur.p.c]) continue;
-        closed[cur.p.r][cur.p.c] = true;
-
-        // Goal reached: reconstruct path
-        if (cur.p.r == goal.r && cur.p.c == goal.c) {
-            Vec2i v = goal;
-            while (!(v.r == start.r && v.c == start.c)) {
-                outPath.push_back(v);
-                Vec2i pr = parent[v.r][v.c];
-                if (pr.r == -1) break;
-                v = pr;
-            }
-            std::reverse(outPath.begin(), outPath.end());
-            return true;
+        // The end of the route is only reached if it can be kept
+        const bool atAnchor = samePos(cur.p, anchor)
+            && (!anchorIsEnd || table.isFree(anchor, clock.at(cur.t), ReservationTable::FOREVER, agent));
+        if (atAnchor || cur.t == window) {
+            end = cur;
+            ended = true;
+            break;
         }
 
-        // Explore neighbors
-        for (int k = 0; k < 4; ++k) {
-            int nr = cur.p.r + dr[k];
-            int nc = cur.p.c + dc[k];
-            if (!passable(nr, nc)) continue;
-
-            int baseCost = 1;
-
-            // Add danger cost if grid is available
-            if (dangerGrid != nullptr) {
-                int dangerValue = dangerGrid[nr][nc];
-                int dangerCost = clampValue(dangerValue / 10, 0, 10);
-                baseCost += dangerCost;
-            }
-
-            int tentative = cur.g + baseCost;
-            if (tentative < gScore[nr][nc]) {
-                gScore[nr][nc] = tentative;
-                parent[nr][nc] = cur.p;
-                int f = tentative + manh({ nr, nc }, goal);
-                open.push(PathNode(nr, nc, tentative, f, cur.p));
-            }
+        const int from = clock.at(cur.t + 1);
+        const int to = clock.at(cur.t + 2);
+        for (int d = 0; d < 5; ++d) {
+            Vec2i q{ cur.p.r + WINDOW_DR[d], cur.p.c + WINDOW_DC[d] };
+            if (!world.inBounds(q.r, q.c) || world.blocksMovement(q.r, q.c)) continue;
+            if (!table.isFree(q, from, to, agent)) continue;
+            if (d < 4 && table.swaps(cur.p, q, from, agent)) continue;
+
+            const int g = cur.g + cost(q);
+            const int64_t k = windowKey(q, cur.t + 1);
+            auto it = visits.find(k);
+            if (it != visits.end() && (it->second.closed || it->second.g <= g)) continue;
+            visits[k] = { g, cur.key, false };
+            open.push({ g + manhattan(q, anchor), g, cur.t + 1, q, k });
         }
     }
 
-    // No path found
-    return false;
+    std::vector<Vec2i> steps; // cells of steps 1..end.t
+    if (ended)
+        for (int64_t k = end.key; visits[k].parent >= 0; k = visits[k].parent)
+            steps.push_back(windowCell(k));
+    std::reverse(steps.begin(), steps.end());
+
+    // Boxed in (no legal step, or only waits for the whole window):
+    // walk the spatial path unreserved rather than stall the squad
+    bool moved = false;
+    for (const Vec2i& p : steps) moved = moved || !samePos(p, start);
+    if (!moved) {
+        outPath = spatial;
+        reservedSteps = depth;
+        return true;
+    }
+
+    std::vector<Vec2i> rest;
+    if (samePos(end.p, anchor))
+        rest.assign(spatial.begin() + depth, spatial.end());
+    else if (!samePos(end.p, target))
+        AStar(world, end.p, target, rest, danger);
+
+    table.reserve(agent, start, clock.now, clock.at(1));
+    for (int t = 1; t <= end.t; ++t) {
+        const Vec2i& p = steps[t - 1];
+        const bool parks = t == end.t && rest.empty()
+            && table.isFree(p, clock.at(t), ReservationTable::FOREVER, agent);
+        table.reserve(agent, p, clock.at(t), parks ? ReservationTable::FOREVER : clock.at(t + 1));
+    }
+
+    outPath = steps;
+    outPath.insert(outPath.end(), rest.begin(), rest.end());
+    reservedSteps = end.t;
+    return true;
 }
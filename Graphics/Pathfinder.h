@@ -1,20 +1,32 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include "PathNode.h"
 #include "Types.h"
+#include "Grid.h"
+#include "PathCache.h"
+#include "FirstMoveTable.h"
+#include "FlowField.h"
+#include "GridKernels.h"
 
-// Forward declaration
+// Forward declarations
 class Map;
+class SafetyMap;
+class ReservationTable;
+struct StepClock;
+struct SearchScratch;
 
 // ============================================================
 // Pathfinder.h
 // Implements the A* pathfinding algorithm with optional
-// safety-aware routing using a danger grid.
+// safety-aware routing using a danger grid. Single-goal results
+// are kept in a PathCache keyed by the map and danger versions.
 // ============================================================
 class Pathfinder {
 public:
     // Runs A* search on the given map.
-    // If 'dangerGrid' is provided, safer routes (lower danger) are preferred.
+    // If 'danger' is provided, safer routes (lower danger) are preferred.
     // Returns true and fills 'outPath' with cells from start (excluded) to goal (included)
     // if a path exists; otherwise returns false.
     static bool AStar(
@@ -22,6 +34,187 @@ public:
         const Vec2i& start,
         const Vec2i& goal,
         std::vector<Vec2i>& outPath,
-        const int dangerGrid[MSZ][MSZ] = nullptr
+        const SafetyMap* danger = nullptr
     );
+
+    // Multi-goal search: one A* from 'start' toward every cell in 'goals'
+    // that stops at the first goal it reaches - the cheapest one under the
+    // same step costs. Returns that goal's index and fills 'outPath', or
+    // returns -1 if no goal is reachable.
+    static int AStarNearest(
+        const Map& world,
+        const Vec2i& start,
+        const std::vector<Vec2i>& goals,
+        std::vector<Vec2i>& outPath,
+        const SafetyMap* danger = nullptr
+    );
+
+    // Windowed cooperative A* (WHCA*): plans the first 'window' steps
+    // toward 'goal' in space-time - each step moves or waits, at the
+    // frames of 'clock' - around the reservations of 'agent's team,
+    // reserves them in 'table' and follows the spatial A* path after
+    // that. A goal another agent is parked on is swapped for the
+    // nearest free cell. Fills 'outPath' (waits repeat a cell) and
+    // 'reservedSteps'; false if the goal is unreachable.
+    static bool AStarWindow(
+        const Map& world,
+        ReservationTable& table,
+        int agent,
+        const StepClock& clock,
+        const Vec2i& start,
+        const Vec2i& goal,
+        int window,
+        std::vector<Vec2i>& outPath,
+        int& reservedSteps,
+        const SafetyMap* danger = nullptr
+    );
+
+    // Hit / miss counts of the AStar result cache
+    static const PathCacheStats& cacheStats();
+
+    // Optional first-move table (battle --first-moves). While it matches
+    // the terrain, danger-free AStar queries walk it instead of searching.
+    static FirstMoveTable& firstMoves();
+    static long long firstMoveWalks();
+
+    // Flow field for a squad sent to 'goal' (Commander::dispatchOrders),
+    // grown until it covers 'starts'. While the terrain and 'danger' are
+    // unchanged, AStar and PathSearch answer queries to 'goal' from any
+    // cell it settled by walking it. The last SQUAD_FIELDS are kept.
+    static void shareField(const Map& world, const Vec2i& goal,
+        const std::vector<Vec2i>& starts, const SafetyMap* danger = nullptr);
+    static long long fieldWalks();
+};
+
+// ============================================================
+// Route
+// A multi-leg trip (storage -> soldier -> home) set up in one
+// call. Stops are fixed (storages, homes) or dynamic (soldiers).
+// A leg between two fixed cells depends only on the terrain, so
+// it is planned once per map version (without danger) and shared
+// by every agent. Legs touching a dynamic stop are searched when
+// they are walked, and again only if that stop moved or the agent
+// left the route.
+// ============================================================
+struct RouteStop {
+    Vec2i cell;
+    bool fixed;  // never moves (storage, home)
+};
+
+class Route {
+public:
+    // Sets up every leg from 'start' through 'stops': static legs are
+    // fetched, the rest checked for reachability. False (and an
+    // empty route) if any stop cannot be reached.
+    bool plan(const Map& world, const Vec2i& start, bool startFixed,
+        const std::vector<RouteStop>& stops);
+
+    // Path of leg i for an agent at 'from', with stop i now at 'stop'
+    // (cells after 'from', up to the stop). Re-planned only if either
+    // end changed; nullptr if unreachable.
+    const std::vector<Vec2i>* walk(const Map& world, int i, const Vec2i& from,
+        const Vec2i& stop, const SafetyMap* danger);
+
+    void clear() { stops.clear(); legs.clear(); }
+    bool empty() const { return stops.empty(); }
+    int legCount() const { return (int)legs.size(); }
+
+private:
+    struct Leg {
+        Vec2i from{ -1, -1 };      // where the planned path starts
+        bool planned = false;
+        std::vector<Vec2i> path;
+    };
+
+    Vec2i origin{ -1, -1 };
+    bool originFixed = false;
+    std::vector<RouteStop> stops;
+    std::vector<Leg> legs;
+
+    Vec2i legStart(int i) const { return (i == 0) ? origin : stops[i - 1].cell; }
+    bool legStartFixed(int i) const { return (i == 0) ? originFixed : stops[i - 1].fixed; }
+};
+
+// ============================================================
+// PathSearch
+// A single-goal A* that stops after a node budget and resumes on
+// a later tick, so one long danger-weighted query on a big map is
+// spread over several ticks instead of stalling one. Queries that
+// need no long search - unreachable goals, first-move table walks,
+// cache hits, starts whose component fits the budget - are answered
+// at once by Pathfinder::AStar.
+//
+// Per-cell state lives in map-sized arrays taken from a shared pool
+// while a search is in flight (stamped, so nothing is cleared per
+// query), so a step costs the same on any map size and an idle
+// object holds nothing. Closed cells keep their parents, which makes the closed
+// set a tree rooted at the start: while the search runs, an agent
+// can walk the tree toward the closed cell nearest the goal (lowest
+// h), and the finished path is re-routed through the tree from
+// wherever the agent stands by then. Danger is read when a cell is
+// reached, so a SafetyMap that changes mid-search only skews the
+// remaining costs; a terrain change restarts the search.
+// ============================================================
+class PathSearch {
+public:
+    enum Status { SEARCH_IDLE, SEARCH_RUNNING, SEARCH_FOUND, SEARCH_FAILED };
+
+    PathSearch();
+    ~PathSearch();
+    PathSearch(const PathSearch&) = delete;
+    PathSearch& operator=(const PathSearch&) = delete;
+
+    // Starts a query (cancelling any other). Finishes at once if a
+    // full search cannot expand more than 'nodeBudget' nodes.
+    Status begin(const Map& world, const Vec2i& start, const Vec2i& goal,
+        const SafetyMap* danger, int nodeBudget);
+
+    // Expands up to 'nodeBudget' more nodes of a running search
+    Status step(int nodeBudget);
+
+    // Drops the query and hands its arrays back to the pool
+    void cancel();
+
+    Status status() const { return state; }
+    bool running() const { return state == SEARCH_RUNNING; }
+    long long expanded() const { return nExpanded; }
+
+    // Cells after 'from' (a cell of the tree: the start or any cell an
+    // earlier route went through) up to the goal once found, or up to
+    // the closed cell nearest the goal while running. False if 'from'
+    // is not in the tree.
+    bool routeFrom(const Vec2i& from, std::vector<Vec2i>& out) const;
+
+private:
+    struct OpenEntry {
+        int f;
+        int g;
+        int key;
+    };
+
+    Status state = SEARCH_IDLE;
+    const Map* world = nullptr;
+    const SafetyMap* danger = nullptr;
+    Vec2i start{ -1, -1 };
+    Vec2i goal{ -1, -1 };
+    uint32_t terrain = 0;       // Map::terrainVersion the tree was grown on
+    uint32_t dangerVersion = 0; // SafetyMap::version at begin (for the cache)
+    long long nExpanded = 0;
+    LandmarkView landmarks;     // ALT tables of the terrain (count 0: Manhattan)
+    int goalDist[LandmarkView::MAX];
+    int lastStep = 0;           // what entering the goal costs beyond 1
+
+    std::unique_ptr<SearchScratch> scratch; // pooled, held while the tree is needed
+    std::vector<OpenEntry> open;         // binary heap (ComparePathNode order)
+    int bestKey = -1;                    // closed cell with the lowest h
+    int bestH = 0;
+    std::vector<Vec2i> found;            // start -> goal once found (start excluded)
+
+    void restart();
+    int stepCost(const Vec2i& p) const;
+    int heuristic(const Vec2i& p) const;
+    bool closed(int k) const;
+    bool treeRoute(const Vec2i& from, int toKey, std::vector<Vec2i>& out) const;
+    int key(const Vec2i& p) const;
+    Vec2i cellOf(int k) const;
 };
@@ -0,0 +1,108 @@
+#include "ProjectileSystem.h"
+#include "Map.h"
+#include "glut.h"
+#include <cmath>
+
+// ============================================================
+// Grenade fragment directions (unit vectors, 360 / 20 degrees apart)
+// ============================================================
+static const float kFragDirX[NUM_GRENADE_BULLETS] = {
+     1.0000000f,  0.9510565f,  0.8090170f,  0.5877853f,  0.3090170f,
+     0.0000000f, -0.3090170f, -0.5877853f, -0.8090170f, -0.9510565f,
+    -1.0000000f, -0.9510565f, -0.8090170f, -0.5877853f, -0.3090170f,
+     0.0000000f,  0.3090170f,  0.5877853f,  0.8090170f,  0.9510565f
+};
+
+static const float kFragDirY[NUM_GRENADE_BULLETS] = {
+     0.0000000f,  0.3090170f,  0.5877853f,  0.8090170f,  0.9510565f,
+     1.0000000f,  0.9510565f,  0.8090170f,  0.5877853f,  0.3090170f,
+     0.0000000f, -0.3090170f, -0.5877853f, -0.8090170f, -0.9510565f,
+    -1.0000000f, -0.9510565f, -0.8090170f, -0.5877853f, -0.3090170f
+};
+
+// ============================================================
+// Constructor
+// ============================================================
+ProjectileSystem::ProjectileSystem() {}
+
+// ============================================================
+// Spawning
+// ============================================================
+void ProjectileSystem::spawn(float px, float py, float dirX, float dirY) {
+    int i;
+    if (count < MAX_PROJECTILES) {
+        i = count++;
+    }
+    else {
+        // Pool full: overwrite slots in turn
+        i = recycle;
+        recycle = (recycle + 1) % MAX_PROJECTILES;
+    }
+
+    x[i] = px;
+    y[i] = py;
+    dx[i] = dirX * BULLET_SPEED;
+    dy[i] = dirY * BULLET_SPEED;
+    life[i] = BULLET_LIFE;
+}
+
+void ProjectileSystem::fireBullet(double startX, double startY, double targetX, double targetY) {
+    double ddx = targetX - startX;
+    double ddy = targetY - startY;
+    double len = std::sqrt(ddx * ddx + ddy * ddy);
+    if (len < 0.001) len = 0.001; // prevent division by zero
+
+    spawn((float)startX, (float)startY, (float)(ddx / len), (float)(ddy / len));
+}
+
+void ProjectileSystem::spawnGrenade(double posX, double posY) {
+    for (int k = 0; k < NUM_GRENADE_BULLETS; ++k)
+        spawn((float)posX, (float)posY, kFragDirX[k], kFragDirY[k]);
+}
+
+// ============================================================
+// Update
+// ============================================================
+void ProjectileSystem::update(const Map& world) {
+    const int n = count;
+
+    // 1. Integrate (branch-free, vectorizes)
+    for (int i = 0; i < n; ++i) {
+        x[i] += dx[i];
+        y[i] += dy[i];
+        life[i] -= 1;
+    }
+
+    // 2. Retire expired, out-of-bounds or blocked projectiles (swap-remove)
+    for (int i = 0; i < count; ) {
+        bool dead = life[i] <= 0 ||
+            x[i] < 0 || x[i] >= world.cols() || y[i] < 0 || y[i] >= world.rows() ||
+            world.blocksMovement((int)y[i], (int)x[i]);
+
+        if (!dead) { ++i; continue; }
+
+        int last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        dx[i] = dx[last];
+        dy[i] = dy[last];
+        life[i] = life[last];
+    }
+
+    if (recycle >= count) recycle = 0;
+}
+
+// ============================================================
+// Render: each projectile is a small red diamond
+// ============================================================
+void ProjectileSystem::draw() const {
+    glColor3d(1.0, 0.1, 0.1); // bright red
+    for (int i = 0; i < count; ++i) {
+        glBegin(GL_POLYGON);
+        glVertex2d(x[i] - 0.15, y[i]);
+        glVertex2d(x[i], y[i] + 0.15);
+        glVertex2d(x[i] + 0.15, y[i]);
+        glVertex2d(x[i], y[i] - 0.15);
+        glEnd();
+    }
+}
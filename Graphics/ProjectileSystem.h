@@ -0,0 +1,47 @@
+#pragma once
+#include "Definitions.h"
+
+// Forward declaration
+class Map;
+
+// ============================================================
+// ProjectileSystem
+// Pooled bullets and grenade fragments owned by the match.
+// Storage is structure-of-arrays with a fixed capacity, so
+// firing never allocates; dead projectiles are swap-removed
+// and, when the pool is full, slots are recycled round-robin
+// like a ring buffer.
+// ============================================================
+const float BULLET_SPEED = 0.1f;      // cells per frame
+const int BULLET_LIFE = 40;           // frames before a bullet disappears
+const int NUM_GRENADE_BULLETS = 20;   // fragments per grenade
+const int MAX_PROJECTILES = 1024;     // pool capacity
+
+class ProjectileSystem {
+public:
+    ProjectileSystem();
+
+    // --- Spawning ---
+    void fireBullet(double startX, double startY, double targetX, double targetY);
+    void spawnGrenade(double posX, double posY); // radial burst of fragments
+
+    // --- Simulation / rendering ---
+    void update(const Map& world); // advance one frame and retire dead projectiles
+    void draw() const;
+    void clear() { count = 0; recycle = 0; }
+
+    int size() const { return count; }
+
+private:
+    void spawn(float px, float py, float dirX, float dirY);
+
+    // --- SoA storage ---
+    float x[MAX_PROJECTILES];
+    float y[MAX_PROJECTILES];
+    float dx[MAX_PROJECTILES];
+    float dy[MAX_PROJECTILES];
+    int life[MAX_PROJECTILES];
+
+    int count = 0;   // live projectiles occupy [0, count)
+    int recycle = 0; // next slot to overwrite when the pool is full
+};
@@ -6,6 +6,8 @@
 #include "Pathfinder.h"
 #include "SafetyMap.h"
 #include "Warrior.h"
+#include "TeamRoster.h"
+#include "EventScheduler.h"
 #include <cstdio>
 #include <algorithm>
 
@@ -17,86 +19,125 @@ extern std::vector<Agent*> gTeamBlue;
 extern SafetyMap* gDangerOrange;
 extern SafetyMap* gDangerBlue;
 extern Map* gWorldForStates;
+extern TeamRoster* gRosterOrange;
+extern TeamRoster* gRosterBlue;
 
 // ------------------------------------------------------------
 // Utility
 // ------------------------------------------------------------
 static inline bool inWorld(int r, int c) {
-    return (r >= 0 && r < MSZ && c >= 0 && c < MSZ);
+    return gWorldForStates && gWorldForStates->inBounds(r, c);
 }
 
 // ------------------------------------------------------------
 // Constructor
 // ------------------------------------------------------------
-Provider::Provider(TeamColor t, int r, int c) : Agent(t, r, c) {
+Provider::Provider(TeamColor t, int r, int c) : Agent(t, ROLE_PROVIDER, r, c) {
     homePos = { r, c };
 }
 
 // ------------------------------------------------------------
 // Find a teammate that needs ammunition
+// Nearest by walking distance (one multi-goal search), so an
+// unreachable warrior is never picked.
 // ------------------------------------------------------------
 Agent* Provider::pickAmmoTarget(const Order& o) {
-    auto& team = (getTeam() == TEAM_ORANGE) ? gTeamOrange : gTeamBlue;
-    Agent* best = nullptr;
-    int bestD = 1e9;
-
+    if (!gWorldForStates) return nullptr;
     Vec2i anchor = (o.targetRow >= 0 && o.targetCol >= 0)
         ? Vec2i{ o.targetRow, o.targetCol }
     : this->getPos();
 
-    for (auto* a : team) {
-        if (a == this) continue;
-        if (auto* w = dynamic_cast<Warrior*>(a)) {
-            if (w->isAlive() && w->getBullets() == 0) {
-                int d = std::abs(a->row() - anchor.r) + std::abs(a->col() - anchor.c);
-                if (d < bestD) { bestD = d; best = a; }
-            }
+    const TeamRoster& roster = (getTeam() == TEAM_ORANGE) ? *gRosterOrange : *gRosterBlue;
+    std::vector<Agent*> empty;
+    std::vector<Vec2i> goals;
+    for (auto* w : roster.warriors()) {
+        if (w->isAlive() && w->getBullets() == 0) {
+            empty.push_back(w);
+            goals.push_back(w->getPos());
         }
     }
-    return best;
+
+    // A single candidate needs no search, only its component
+    if (goals.size() == 1)
+        return gWorldForStates->connected(anchor, goals[0]) ? empty[0] : nullptr;
+
+    std::vector<Vec2i> path;
+    int k = Pathfinder::AStarNearest(*gWorldForStates, anchor, goals, path);
+    return (k < 0) ? nullptr : empty[k];
 }
 
 // ------------------------------------------------------------
 // Plan a safe path using A* with optional danger map
 // ------------------------------------------------------------
+const SafetyMap* Provider::teamDanger() const {
+    return (getTeam() == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
+}
+
 bool Provider::planPathTo(Map& world, const Vec2i& goal) {
     if (!inWorld(goal.r, goal.c)) return false;
+    // Walled-off goal: fail before any search runs
+    if (!world.connected(getPos(), goal)) return false;
 
     std::vector<Vec2i> p;
-    const SafetyMap* sm = (getTeam() == TEAM_ORANGE) ? gDangerOrange : gDangerBlue;
-    const int (*danger)[MSZ] = sm ? sm->getGridPtr() : nullptr;
+    const SafetyMap* danger = teamDanger();
 
+    // Danger only re-weights steps, so a danger-free retry would fail
+    // exactly when this search does
     bool ok = Pathfinder::AStar(world, getPos(), goal, p, danger);
-    if (!ok || p.empty()) {
-        ok = Pathfinder::AStar(world, getPos(), goal, p, nullptr);
-        if (!ok || p.empty()) return false;
-    }
+    if (!ok || p.empty()) return false;
 
     setPath(p);
     setTarget(goal);
     return true;
 }
 
+// ------------------------------------------------------------
+// Mission route
+// Set up once per order: the static home <-> storage legs come
+// from the shared cache, the soldier legs are searched when walked
+// (again only if the soldier moved or the provider left the route).
+// ------------------------------------------------------------
+bool Provider::planMission(Map& world) {
+    if (!inWorld(ammoStorage.r, ammoStorage.c) || !inWorld(soldierTarget.r, soldierTarget.c)) return false;
+
+    const Vec2i& p = getPos();
+    const bool atHome = (p.r == homePos.r && p.c == homePos.c);
+    std::vector<RouteStop> stops = { { ammoStorage, true }, { soldierTarget, false }, { homePos, true } };
+    if (!route.plan(world, p, atHome, stops)) return false;
+    return walkLeg(world, LEG_STORAGE, ammoStorage);
+}
+
+// Sets the path of route leg 'leg' toward 'goal' (false if empty / unreachable)
+bool Provider::walkLeg(Map& world, int leg, const Vec2i& goal) {
+    if (leg >= route.legCount()) return planPathTo(world, goal); // no route for this leg
+
+    const std::vector<Vec2i>* path = route.walk(world, leg, getPos(), goal, teamDanger());
+    if (!path || path->empty()) return false;
+    setPath(*path);
+    setTarget(goal);
+    return true;
+}
+
 // ------------------------------------------------------------
 // Receive order from Commander (RESUPPLY type)
 // ------------------------------------------------------------
 void Provider::receiveOrder(const Order& o) {
     if (o.type != OrderType::RESUPPLY) {
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     if (o.targetRow < 0 || o.targetCol < 0) {
         /*printf("Provider (%s): invalid order target.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     if (!inWorld(ammoStorage.r, ammoStorage.c)) {
      /*   printf("Provider (%s): ammoStorage invalid.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
@@ -104,22 +145,22 @@ void Provider::receiveOrder(const Order& o) {
     if (!targetPtr) {
         /*printf("Provider (%s): no soldier needs resupply.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     soldierTarget = targetPtr->getPos();
 
-    if (!gWorldForStates || !planPathTo(*gWorldForStates, ammoStorage)) {
+    if (!gWorldForStates || !planMission(*gWorldForStates)) {
         /*printf("Provider (%s): path to storage failed.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         return;
     }
 
     onReturn = false;
     reachedStorageOnce = false;
-    setState(new MoveToTarget());
+    setState(MoveToTarget::instance());
     moving = true;
 
     /*printf("Provider (%s): RESUPPLY → storage (%d,%d) → soldier (%d,%d)\n",
@@ -134,36 +175,37 @@ void Provider::onReachedStorage() {
     if (!targetPtr || !targetPtr->isAlive()) {
         /*printf("Provider (%s): invalid soldier after storage.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         moving = false;
         return;
     }
 
-    // Skip if soldier is standing inside the storage cell
+    // Soldier standing inside the storage cell: hand over right here
+    // (update() sees the finished leg with onReturn set)
     soldierTarget = targetPtr->getPos();
     if (soldierTarget.r == getPos().r && soldierTarget.c == getPos().c) {
         /*printf("Provider (%s): soldier is at storage location — skipping move.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        onReturn = false;
-        setState(new Idle());
+        onReturn = true;
+        setState(Idle::instance());
         moving = false;
         return;
     }
 
-    // Plan path from storage to soldier
-    if (!gWorldForStates || !planPathTo(*gWorldForStates, soldierTarget)) {
+    // Path from storage to soldier (the planned leg unless the soldier moved)
+    if (!gWorldForStates || !walkLeg(*gWorldForStates, LEG_SOLDIER, soldierTarget)) {
         /*printf("Provider (%s): path storage→soldier failed.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         moving = false;
         return;
     }
 
-    // Safety check for very short paths
-    if (getPath().size() <= 1) {
+    // Safety check for empty paths (one step: the soldier waits next door)
+    if (getPath().empty()) {
         /*printf("Provider (%s): path too short, staying put.\n",
             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-        setState(new Idle());
+        setState(Idle::instance());
         moving = false;
         return;
     }
@@ -172,7 +214,7 @@ void Provider::onReachedStorage() {
     onReturn = true;
     moving = true;
 
-    setState(new MoveToTarget());
+    setState(MoveToTarget::instance());
    /* printf("Provider (%s): leaving storage, heading to soldier at (%d,%d) pathLen=%zu\n",
         (team == TEAM_ORANGE ? "Orange" : "Blue"),
         soldierTarget.r, soldierTarget.c, getPath().size());*/
@@ -185,10 +227,6 @@ void Provider::update(Map& world) {
     if (!isAlive()) return;
     Agent::update(world);
 
-    static int pathRecalcCooldown = 0;
-    if (pathRecalcCooldown > 0) pathRecalcCooldown--;
-
-
     if (pathIndex >= 0) {
         bool walking = advanceAlongPath(world);
         if (walking) return;
@@ -210,10 +248,10 @@ void Provider::update(Map& world) {
                 int drift = std::abs(livePos.r - soldierTarget.r) + std::abs(livePos.c - soldierTarget.c);
                 if (drift >= 2) {
                     soldierTarget = livePos;
-                    if (pathRecalcCooldown == 0 && gWorldForStates && planPathTo(*gWorldForStates, soldierTarget)) {
-                        pathRecalcCooldown = 60; // ~1 second
+                    if (now() >= replanReadyFrame && gWorldForStates && planPathTo(*gWorldForStates, soldierTarget)) {
+                        armTimer(replanReadyFrame, TIMER_REPLAN, 60); // ~1 second
                         setTarget(soldierTarget);
-                        setState(new MoveToTarget());
+                        setState(MoveToTarget::instance());
                         moving = true;
                         return;
                     }
@@ -223,34 +261,33 @@ void Provider::update(Map& world) {
 
             // --- Reached target soldier ---
             if (targetPtr && targetPtr->isAlive()) {
-                if (auto* w = dynamic_cast<Warrior*>(targetPtr)) {
+                if (targetPtr->getRole() == ROLE_WARRIOR) {
+                    auto* w = static_cast<Warrior*>(targetPtr);
                     w->reload();
                     w->refillGrenades();
-                    w->setState(new Idle());
+                    w->setState(Idle::instance());
                     /*printf("🔋 Provider (%s): resupplied Warrior at (%d,%d)\n",
                         (team == TEAM_ORANGE ? "Orange" : "Blue"),
                         soldierTarget.r, soldierTarget.c);*/
 
 
                     
-                    auto& enemyTeam = (team == TEAM_ORANGE) ? gTeamBlue : gTeamOrange;
-                    bool anyEnemyAlive = false;
-                    for (auto* e : enemyTeam)
-                        if (e->isAlive()) { anyEnemyAlive = true; break; }
+                    const TeamRoster& enemyRoster = (team == TEAM_ORANGE) ? *gRosterBlue : *gRosterOrange;
+                    bool anyEnemyAlive = enemyRoster.aliveTotal() > 0;
 
                     if (anyEnemyAlive) {
                         
-                        int r = (team == TEAM_ORANGE) ? MSZ - 8 : 8;
-                        int c = (team == TEAM_ORANGE) ? MSZ - 8 : 8;
-                        w->receiveOrder(Order(OrderType::ATTACK, r, c));
+                        TeamColor enemyTeam = (team == TEAM_ORANGE) ? TEAM_BLUE : TEAM_ORANGE;
+                        Vec2i target = gWorldForStates->rallyCorner(enemyTeam, 8);
+                        w->receiveOrder(Order(OrderType::ATTACK, target.r, target.c));
                         /*printf("⚔️ Warrior (%s): resupplied and resuming mission!\n",
                             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
                     }
                     else {
                        
-                        int r = (team == TEAM_ORANGE) ? MSZ - 5 : 5;
-                        int c = (team == TEAM_ORANGE) ? MSZ - 5 : 5;
-                        w->receiveOrder(Order(OrderType::MOVE, r, c));
+                        TeamColor enemyTeam = (team == TEAM_ORANGE) ? TEAM_BLUE : TEAM_ORANGE;
+                        Vec2i target = gWorldForStates->rallyCorner(enemyTeam, 5);
+                        w->receiveOrder(Order(OrderType::MOVE, target.r, target.c));
                         /*printf("🏁 Warrior (%s): no enemies left, advancing forward.\n",
                             (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
                     }
@@ -258,10 +295,10 @@ void Provider::update(Map& world) {
             }
 
 
-            // Plan path back home
-            if (gWorldForStates && planPathTo(*gWorldForStates, homePos)) {
+            // Path back home (the planned leg unless the route was left)
+            if (gWorldForStates && walkLeg(*gWorldForStates, LEG_HOME, homePos)) {
                 setTarget(homePos);
-                setState(new MoveToTarget());
+                setState(MoveToTarget::instance());
                 moving = true;
                 onReturn = false;
                 /*printf("🏠 Provider (%s): returning home.\n",
@@ -270,7 +307,7 @@ void Provider::update(Map& world) {
             else {
                 /*printf("Provider (%s): failed to plan path home.\n",
                     (team == TEAM_ORANGE ? "Orange" : "Blue"));*/
-                setState(new Idle());
+                setState(Idle::instance());
                 moving = false;
                 onReturn = false;
             }
@@ -287,11 +324,11 @@ void Provider::update(Map& world) {
     //        if (auto* w = dynamic_cast<Warrior*>(a)) {
     //            if (w->isAlive() && w->getBullets() == 0) {
     //                soldierTarget = w->getPos();
-    //                if (pathRecalcCooldown == 0 && gWorldForStates && planPathTo(*gWorldForStates, ammoStorage)) {
-    //                    pathRecalcCooldown = 200;
+    //                if (now() >= replanReadyFrame && gWorldForStates && planPathTo(*gWorldForStates, ammoStorage)) {
+    //                    armTimer(replanReadyFrame, TIMER_REPLAN, 200);
     //                    onReturn = false;
     //                    reachedStorageOnce = false;
-    //                    setState(new MoveToTarget());
+    //                    setState(MoveToTarget::instance());
     //                    moving = true;
     //                }
     //                break;
@@ -302,3 +339,17 @@ void Provider::update(Map& world) {
     //}
 
 }
+
+// ------------------------------------------------------------
+// Event scheduling
+// ------------------------------------------------------------
+void Provider::hashState(StateHash& h) const {
+    Agent::hashState(h);
+    h.add(homePos);
+    h.add(ammoStorage);
+    h.add(soldierTarget);
+    h.add(int64_t(onReturn));
+    h.add(int64_t(reachedStorageOnce));
+    h.add(targetPtr);
+    h.add(int64_t(replanReadyFrame));
+}
@@ -2,6 +2,7 @@
 #include "Agent.h"
 #include "Order.h"
 #include "Types.h"
+#include "Pathfinder.h"
 #include <vector>
 
 // Forward declarations
@@ -25,6 +26,9 @@ public:
     void receiveOrder(const Order& o) override;
     void onReachedStorage();
 
+    // --- Event scheduling ---
+    void hashState(StateHash& h) const override;
+
     // --- Key positions ---
     Vec2i homePos{ -1, -1 };        // spawn position (for returning)
     Vec2i ammoStorage{ -1, -1 };    // team's ammo warehouse
@@ -34,8 +38,16 @@ public:
 
 private:
     Agent* targetPtr = nullptr;     // pointer to current soldier target
+    int replanReadyFrame = 0;       // match frame from which re-planning is allowed again
+
+    // --- Mission route: storage -> soldier -> home ---
+    enum { LEG_STORAGE, LEG_SOLDIER, LEG_HOME };
+    Route route;
 
     // --- Internal helpers ---
     Agent* pickAmmoTarget(const Order& o);
     bool planPathTo(Map& world, const Vec2i& goal);
+    bool planMission(Map& world);
+    bool walkLeg(Map& world, int leg, const Vec2i& goal);
+    const SafetyMap* teamDanger() const;
 };
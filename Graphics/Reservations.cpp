@@ -0,0 +1,79 @@
+#include "Reservations.h"
+#include <algorithm>
+
+// ============================================================
+// Lookup
+// ============================================================
+const std::vector<ReservationTable::Slot>* ReservationTable::slotsAt(const Vec2i& p) const {
+    auto it = cells.find(key(p));
+    return (it == cells.end()) ? nullptr : &it->second;
+}
+
+bool ReservationTable::isFree(const Vec2i& cell, int from, int to, int agent) const {
+    const std::vector<Slot>* slots = slotsAt(cell);
+    if (!slots) return true;
+    for (const Slot& s : *slots)
+        if (s.agent != agent && s.from < to && from < s.to) return false;
+    return true;
+}
+
+bool ReservationTable::swaps(const Vec2i& from, const Vec2i& to, int at, int agent) const {
+    const std::vector<Slot>* there = slotsAt(to);
+    const std::vector<Slot>* here = slotsAt(from);
+    if (!there || !here) return false;
+    for (const Slot& s : *there) {
+        if (s.agent == agent || s.to != at) continue;
+        for (const Slot& t : *here)
+            if (t.agent == s.agent && t.from == at) return true;
+    }
+    return false;
+}
+
+bool ReservationTable::isParked(const Vec2i& cell, int agent) const {
+    const std::vector<Slot>* slots = slotsAt(cell);
+    if (!slots) return false;
+    for (const Slot& s : *slots)
+        if (s.agent != agent && s.to == FOREVER) return true;
+    return false;
+}
+
+bool ReservationTable::parkedOn(int agent, const Vec2i& cell) const {
+    if (agent < 0 || agent >= (int)held.size() || held[agent].size() != 1) return false;
+    const Vec2i& p = held[agent][0];
+    if (p.r != cell.r || p.c != cell.c) return false;
+    for (const Slot& s : *slotsAt(p))
+        if (s.agent == agent) return s.to == FOREVER;
+    return false;
+}
+
+// ============================================================
+// Updates
+// ============================================================
+void ReservationTable::reserve(int agent, const Vec2i& cell, int from, int to) {
+    if (agent < 0 || from >= to) return;
+    if (agent >= (int)held.size()) held.resize(agent + 1);
+    cells[key(cell)].push_back({ agent, from, to });
+    held[agent].push_back(cell);
+    ++count;
+}
+
+void ReservationTable::release(int agent) {
+    if (agent < 0 || agent >= (int)held.size()) return;
+    for (const Vec2i& p : held[agent]) {
+        auto it = cells.find(key(p));
+        if (it == cells.end()) continue;
+        std::vector<Slot>& slots = it->second;
+        const size_t before = slots.size();
+        slots.erase(std::remove_if(slots.begin(), slots.end(),
+            [agent](const Slot& s) { return s.agent == agent; }), slots.end());
+        count -= before - slots.size();
+        if (slots.empty()) cells.erase(it);
+    }
+    held[agent].clear();
+}
+
+void ReservationTable::clear() {
+    cells.clear();
+    held.clear();
+    count = 0;
+}
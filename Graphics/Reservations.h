@@ -0,0 +1,73 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+
+// ============================================================
+// ReservationTable
+// Space-time reservations of one team: which agent holds which
+// cell during which frames of the match clock. Cooperative
+// (WHCA*) windows are planned against it one agent after another,
+// so teammates route around each other's next steps instead of
+// stacking on a cell and sorting it out afterwards.
+//
+// A reservation is a half-open frame interval [from, to); one
+// that runs to FOREVER parks the agent on the cell (it stopped
+// there), which later plans treat as a wall from that frame on.
+// Cells are keyed by coordinates, so the table holds only what is
+// reserved and costs nothing per map cell.
+// ============================================================
+
+// Frames at which an agent can take its next steps: step t (t >= 1)
+// lands at firstStep + (t - 1) * period; step 0 is standing at 'now'.
+struct StepClock {
+    int now;
+    int firstStep;
+    int period;
+
+    int at(int t) const { return t == 0 ? now : firstStep + (t - 1) * period; }
+};
+
+class ReservationTable {
+public:
+    static const int FOREVER = INT_MAX;
+
+    // 'agent' holds 'cell' during [from, to)
+    void reserve(int agent, const Vec2i& cell, int from, int to);
+
+    // No agent other than 'agent' holds 'cell' at any frame of [from, to)
+    bool isFree(const Vec2i& cell, int from, int to, int agent) const;
+
+    // Another agent leaves 'to' for 'from' at frame 'at' - moving the
+    // other way at the same frame would swap the two through each other
+    bool swaps(const Vec2i& from, const Vec2i& to, int at, int agent) const;
+
+    // Another agent is parked on 'cell'
+    bool isParked(const Vec2i& cell, int agent) const;
+
+    // Drops everything 'agent' holds
+    void release(int agent);
+
+    // True if all 'agent' holds is a park on 'cell'
+    bool parkedOn(int agent, const Vec2i& cell) const;
+
+    void clear();
+    size_t reservations() const { return count; }
+
+private:
+    struct Slot {
+        int agent;
+        int from;
+        int to;
+    };
+
+    std::unordered_map<int64_t, std::vector<Slot>> cells;
+    std::vector<std::vector<Vec2i>> held; // cells reserved, indexed by agent id
+    size_t count = 0;
+
+    static int64_t key(const Vec2i& p) { return (int64_t(p.r) << 32) | uint32_t(p.c); }
+    const std::vector<Slot>* slotsAt(const Vec2i& p) const;
+};
@@ -4,38 +4,48 @@
 #include <cmath>
 #include <algorithm>
 
+// Definitions for the kernel constants (std::min takes them by reference)
+constexpr int SafetyMap::MAX_DANGER;
+constexpr int SafetyMap::KERNEL_RADIUS;
+
 // ============================================================
 // Constructor - initialize danger grid
 // ============================================================
-SafetyMap::SafetyMap() {
-    for (int i = 0; i < MSZ; ++i)
-        for (int j = 0; j < MSZ; ++j)
-            grid[i][j] = 0;
+SafetyMap::SafetyMap() : stamp(nextStamp()) {}
+
+uint32_t SafetyMap::nextStamp() {
+    static uint32_t next = 0;
+    return ++next;
 }
 
 // ============================================================
 // Compute danger values from all visible enemy agents
 // ============================================================
 void SafetyMap::compute(const std::vector<Agent*>& enemies) {
+    // Same living enemies on the same cells: the grid would not change
+    std::vector<Vec2i> cells;
+    cells.reserve(enemies.size());
+    for (auto* e : enemies)
+        if (e->isAlive()) cells.push_back(e->getPos());
+
+    bool same = computed && cells.size() == lastEnemies.size();
+    for (size_t i = 0; same && i < cells.size(); ++i)
+        same = cells[i].r == lastEnemies[i].r && cells[i].c == lastEnemies[i].c;
+    if (same) return;
+
+    lastEnemies.swap(cells);
+    computed = true;
+    stamp = nextStamp();
+
     // Reset grid
-    for (int r = 0; r < MSZ; ++r)
-        for (int c = 0; c < MSZ; ++c)
-            grid[r][c] = 0;
+    grid.fill(0);
 
-    // Add cumulative danger influence from all enemies
+    // Add cumulative danger influence from all enemies. The kernel is
+    // zero beyond KERNEL_RADIUS, so only the box around each enemy is
+    // visited and the cost does not grow with the map.
+    if (!kernels) kernels = &selectGridKernels(grid.rows(), grid.cols());
     for (auto* e : enemies) {
         if (!e->isAlive()) continue;
-        int er = e->row();
-        int ec = e->col();
-
-        for (int r = 0; r < MSZ; ++r)
-            for (int c = 0; c < MSZ; ++c) {
-                int dist = std::abs(er - r) + std::abs(ec - c);
-                if (dist < 1) dist = 1;
-
-                // Normalized danger scale (0–20)
-                int danger = std::max(0, 20 - dist * 2);
-                grid[r][c] = std::min(20, grid[r][c] + danger);
-            }
+        kernels->stampDanger(grid.data(), grid.rows(), grid.cols(), e->getPos());
     }
 }
@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include "Definitions.h"
 #include "Agent.h"
+#include "Grid.h"
+#include "GridKernels.h"
 #include <vector>
 
 // ============================================================
@@ -12,25 +14,43 @@ class SafetyMap {
 public:
     SafetyMap();
 
+    void resize(int rows, int cols) {
+        grid.resize(rows, cols, 0);
+        computed = false;
+        stamp = nextStamp();
+        kernels = &selectGridKernels(rows, cols);
+    }
+
     // --- Main computation ---
     // Updates the danger grid based on enemy positions and visibility.
+    // Nothing is redone while no living enemy has moved.
     void compute(const std::vector<Agent*>& enemies);
 
+    // Changes whenever the grid does (unique across maps, never 0),
+    // so cached searches can tell which danger they were costed under
+    uint32_t version() const { return stamp; }
+
     // --- Accessors ---
-    int get(int r, int c) const { return grid[r][c]; }
+    int get(int r, int c) const { return grid(r, c); }
 
     // Safe accessor (normalized to [0,1]) for commander logic
     double at(int r, int c) const {
-        if (r < 0 || r >= MSZ || c < 0 || c >= MSZ) return 1.0;
-        return static_cast<double>(grid[r][c]) / 100.0;
+        if (!grid.inBounds(r, c)) return 1.0;
+        return static_cast<double>(grid(r, c)) / 100.0;
     }
 
-    // Full grid access (for debugging or weighting)
-    const int(&getGrid() const)[MSZ][MSZ]{ return grid; }
+    // Full grid access (used by Pathfinder and MoveToTarget for weighting)
+    const Grid<int>& getGrid() const { return grid; }
 
-        // Pointer accessor (used by Pathfinder and MoveToTarget)
-    const int (*getGridPtr() const)[MSZ] { return grid; }
+    // --- Danger kernel: 20 - 2 * dist, zero from this distance on ---
+    static constexpr int MAX_DANGER = 20;
+    static constexpr int KERNEL_RADIUS = 10;
 
 private:
-    int grid[MSZ][MSZ]; // danger value per cell (0–20 typical range)
+    Grid<int> grid; // danger value per cell (0–20 typical range)
+    const GridKernels* kernels = nullptr;
+    uint32_t stamp;
+    static uint32_t nextStamp();
+    std::vector<Vec2i> lastEnemies; // living enemy cells of the last compute
+    bool computed = false;
 };
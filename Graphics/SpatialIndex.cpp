@@ -0,0 +1,96 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+// ============================================================
+// Constructor / reset
+// ============================================================
+SpatialIndex::SpatialIndex() {
+    reset(DEFAULT_MAP_SIZE, DEFAULT_MAP_SIZE);
+}
+
+void SpatialIndex::reset(int r, int c) {
+    rows = r;
+    cols = c;
+    bRows = (rows + BUCKET - 1) / BUCKET;
+    bCols = (cols + BUCKET - 1) / BUCKET;
+    nextSeq = 0;
+    buckets.assign(size_t(bRows * bCols), std::vector<Entry>());
+}
+
+// ============================================================
+// Maintenance
+// ============================================================
+void SpatialIndex::insert(Agent* a) {
+    if (!a) return;
+    buckets[bucketOf(a->getPos())].push_back({ a, nextSeq++ });
+}
+
+void SpatialIndex::remove(Agent* a) {
+    auto& bucket = buckets[bucketOf(a->getPos())];
+    for (size_t i = 0; i < bucket.size(); ++i)
+        if (bucket[i].agent == a) {
+            bucket.erase(bucket.begin() + i);
+            return;
+        }
+}
+
+void SpatialIndex::move(Agent* a, const Vec2i& from, const Vec2i& to) {
+    int bFrom = bucketOf(from);
+    int bTo = bucketOf(to);
+    if (bFrom == bTo) return;
+
+    auto& src = buckets[bFrom];
+    for (size_t i = 0; i < src.size(); ++i)
+        if (src[i].agent == a) {
+            Entry e = src[i];
+            src[i] = src.back();
+            src.pop_back();
+            buckets[bTo].push_back(e);
+            return;
+        }
+}
+
+// ============================================================
+// k-nearest (ring expansion, stops once the k-th is settled)
+// ============================================================
+int SpatialIndex::kNearest(const Vec2i& from, int k, const AgentFilter& f,
+    std::vector<Agent*>& out, int maxDist) const {
+    out.clear();
+    if (k <= 0 || buckets.empty()) return 0;
+
+    struct Cand { int d; int seq; Agent* a; };
+    std::vector<Cand> cands;
+
+    const int b = bucketOf(from);
+    const int br = b / bCols, bc = b % bCols;
+    const int maxRing = std::max(bRows, bCols);
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        int lb = ringLowerBound(ring);
+        if (maxDist >= 0 && lb > maxDist) break;
+
+        // The k-th candidate is final once no unvisited ring can beat it
+        if ((int)cands.size() >= k) {
+            std::nth_element(cands.begin(), cands.begin() + (k - 1), cands.end(),
+                [](const Cand& x, const Cand& y) { return x.d < y.d || (x.d == y.d && x.seq < y.seq); });
+            if (cands[k - 1].d < lb) break;
+        }
+
+        bool inGrid = visitRing(br, bc, ring, [&](const std::vector<Entry>& bucket) {
+            for (const Entry& e : bucket) {
+                if (!f.accepts(e.agent)) continue;
+                int d = manh(from, e.agent->getPos());
+                if (maxDist >= 0 && d > maxDist) continue;
+                cands.push_back({ d, e.seq, e.agent });
+            }
+            });
+        if (!inGrid && ring > 0) break;
+    }
+
+    std::sort(cands.begin(), cands.end(),
+        [](const Cand& x, const Cand& y) { return x.d < y.d || (x.d == y.d && x.seq < y.seq); });
+
+    int n = std::min(k, (int)cands.size());
+    for (int i = 0; i < n; ++i) out.push_back(cands[i].a);
+    return n;
+}
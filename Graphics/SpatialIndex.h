@@ -0,0 +1,184 @@
+#pragma once
+#include "Definitions.h"
+#include "Types.h"
+#include "Agent.h"
+#include <vector>
+#include <cstdlib>
+
+// ============================================================
+// SpatialIndex
+// Uniform-grid (bucketed) hash of agent positions for neighbour
+// and range queries. Agents are re-bucketed by Agent whenever
+// 'pos' changes, so combat and support searches only visit the
+// buckets around the query point instead of whole team vectors.
+//
+// Distances are Manhattan, matching the rest of the simulation.
+// Ties are broken by insertion order, which equals team-vector
+// order, so results match the old linear scans exactly.
+// ============================================================
+
+// Role bit for AgentFilter::roleMask
+inline unsigned RoleBit(AgentRole r) { return 1u << (unsigned)r; }
+const unsigned ALL_ROLES = (1u << ROLE_COUNT) - 1;
+
+// --- Query filter (team / role / alive) ---
+struct AgentFilter {
+    int team = -1;                 // -1 = any team
+    unsigned roleMask = ALL_ROLES; // RoleBit() combination
+    bool aliveOnly = true;         // skip dead agents
+
+    AgentFilter() = default;
+    AgentFilter(int t, unsigned roles = ALL_ROLES, bool alive = true)
+        : team(t), roleMask(roles), aliveOnly(alive) {
+    }
+
+    bool accepts(const Agent* a) const {
+        if (team >= 0 && a->getTeam() != team) return false;
+        if (!(roleMask & RoleBit(a->getRole()))) return false;
+        if (aliveOnly && !a->isAlive()) return false;
+        return true;
+    }
+};
+
+class SpatialIndex {
+public:
+    static const int BUCKET = 4; // cells per bucket side
+
+    SpatialIndex();
+
+    // --- Maintenance ---
+    void reset(int rows, int cols);
+    void insert(Agent* a);
+    void remove(Agent* a);
+    void move(Agent* a, const Vec2i& from, const Vec2i& to);
+
+    // --- Queries ---
+
+    // Nearest agent passing 'f' and 'accept' (within maxDist if >= 0).
+    // Returns nullptr if none; writes the distance to outDist if given.
+    template <class Pred>
+    Agent* nearest(const Vec2i& from, const AgentFilter& f, Pred accept,
+        int maxDist = -1, int* outDist = nullptr) const;
+
+    Agent* nearest(const Vec2i& from, const AgentFilter& f, int maxDist = -1, int* outDist = nullptr) const {
+        return nearest(from, f, [](const Agent*) { return true; }, maxDist, outDist);
+    }
+
+    // Up to k nearest agents passing 'f', sorted by distance.
+    int kNearest(const Vec2i& from, int k, const AgentFilter& f,
+        std::vector<Agent*>& out, int maxDist = -1) const;
+
+    // Calls fn(Agent*, dist) for every agent within Manhattan 'radius'.
+    template <class Fn>
+    void forEachWithin(const Vec2i& from, int radius, const AgentFilter& f, Fn fn) const;
+
+    int countWithin(const Vec2i& from, int radius, const AgentFilter& f) const {
+        int n = 0;
+        forEachWithin(from, radius, f, [&](Agent*, int) { ++n; });
+        return n;
+    }
+
+private:
+    struct Entry {
+        Agent* agent;
+        int seq; // insertion order (tie-break)
+    };
+
+    int rows = 0, cols = 0;
+    int bRows = 0, bCols = 0;
+    int nextSeq = 0;
+    std::vector<std::vector<Entry>> buckets;
+
+    int bucketOf(const Vec2i& p) const {
+        int br = p.r / BUCKET, bc = p.c / BUCKET;
+        if (br < 0) br = 0; else if (br >= bRows) br = bRows - 1;
+        if (bc < 0) bc = 0; else if (bc >= bCols) bc = bCols - 1;
+        return br * bCols + bc;
+    }
+
+    static int manh(const Vec2i& a, const Vec2i& b) {
+        return std::abs(a.r - b.r) + std::abs(a.c - b.c);
+    }
+
+    // Smallest Manhattan distance any cell of ring k can have from the query
+    static int ringLowerBound(int k) { return (k <= 0) ? 0 : (k - 1) * BUCKET + 1; }
+
+    // Visits the buckets at Chebyshev bucket distance k; returns false if
+    // the ring lies completely outside the grid.
+    template <class Fn>
+    bool visitRing(int br, int bc, int k, Fn fn) const;
+};
+
+// ============================================================
+// Template implementations
+// ============================================================
+template <class Fn>
+bool SpatialIndex::visitRing(int br, int bc, int k, Fn fn) const {
+    if (k == 0) {
+        fn(buckets[br * bCols + bc]);
+        return true;
+    }
+
+    bool any = false;
+    for (int r = br - k; r <= br + k; ++r) {
+        if (r < 0 || r >= bRows) continue;
+        bool edgeRow = (r == br - k || r == br + k);
+        int step = edgeRow ? 1 : 2 * k;
+        for (int c = bc - k; c <= bc + k; c += step) {
+            if (c < 0 || c >= bCols) continue;
+            any = true;
+            fn(buckets[r * bCols + c]);
+        }
+    }
+    return any;
+}
+
+template <class Pred>
+Agent* SpatialIndex::nearest(const Vec2i& from, const AgentFilter& f, Pred accept,
+    int maxDist, int* outDist) const {
+    if (buckets.empty()) return nullptr;
+
+    const int b = bucketOf(from);
+    const int br = b / bCols, bc = b % bCols;
+    const int maxRing = std::max(bRows, bCols);
+
+    Agent* best = nullptr;
+    int bestD = 1e9, bestSeq = 1e9;
+
+    for (int k = 0; k <= maxRing; ++k) {
+        int lb = ringLowerBound(k);
+        if (lb > bestD) break;                    // nothing closer (or tied) beyond this ring
+        if (maxDist >= 0 && lb > maxDist) break;
+
+        bool inGrid = visitRing(br, bc, k, [&](const std::vector<Entry>& bucket) {
+            for (const Entry& e : bucket) {
+                if (!f.accepts(e.agent)) continue;
+                int d = manh(from, e.agent->getPos());
+                if (maxDist >= 0 && d > maxDist) continue;
+                if (d > bestD || (d == bestD && e.seq > bestSeq)) continue;
+                if (!accept(e.agent)) continue;
+                best = e.agent; bestD = d; bestSeq = e.seq;
+            }
+            });
+        if (!inGrid && k > 0) break;
+    }
+
+    if (best && outDist) *outDist = bestD;
+    return best;
+}
+
+template <class Fn>
+void SpatialIndex::forEachWithin(const Vec2i& from, int radius, const AgentFilter& f, Fn fn) const {
+    if (buckets.empty() || radius < 0) return;
+
+    int r0 = std::max(0, (from.r - radius) / BUCKET), r1 = std::min(bRows - 1, (from.r + radius) / BUCKET);
+    int c0 = std::max(0, (from.c - radius) / BUCKET), c1 = std::min(bCols - 1, (from.c + radius) / BUCKET);
+
+    for (int r = r0; r <= r1; ++r)
+        for (int c = c0; c <= c1; ++c)
+            for (const Entry& e : buckets[r * bCols + c]) {
+                if (!f.accepts(e.agent)) continue;
+                int d = manh(from, e.agent->getPos());
+                if (d <= radius) fn(e.agent, d);
+            }
+}
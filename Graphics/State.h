@@ -4,6 +4,9 @@ class Agent;
 // ============================================================
 // State (abstract base class)
 // Defines the interface for FSM (Finite State Machine) states.
+// States are stateless flyweights: each concrete state exposes a
+// shared instance(), and all per-agent data lives in the Agent,
+// so a transition never touches the heap.
 // ============================================================
 class State {
 public:
@@ -0,0 +1,47 @@
+#include "TeamRoster.h"
+#include "Agent.h"
+#include "Commander.h"
+#include "Warrior.h"
+#include "Medic.h"
+#include "Provider.h"
+
+// ============================================================
+// Registration
+// ============================================================
+void TeamRoster::add(Agent* a) {
+    if (!a) return;
+    members.push_back(a);
+
+    // Role is fixed at construction, so the downcast is safe
+    switch (a->getRole()) {
+    case ROLE_COMMANDER: commanderList.push_back(static_cast<Commander*>(a)); break;
+    case ROLE_WARRIOR:   warriorList.push_back(static_cast<Warrior*>(a));     break;
+    case ROLE_MEDIC:     medicList.push_back(static_cast<Medic*>(a));         break;
+    case ROLE_PROVIDER:  providerList.push_back(static_cast<Provider*>(a));   break;
+    default: break;
+    }
+
+    if (a->isAlive()) alive[a->getRole()]++;
+    a->setRoster(this);
+}
+
+void TeamRoster::clear() {
+    for (auto* a : members) a->setRoster(nullptr);
+    members.clear();
+    commanderList.clear();
+    warriorList.clear();
+    medicList.clear();
+    providerList.clear();
+    for (int i = 0; i < ROLE_COUNT; ++i) alive[i] = 0;
+}
+
+// ============================================================
+// Death / revive notifications
+// ============================================================
+void TeamRoster::onDeath(const Agent* a) {
+    if (alive[a->getRole()] > 0) alive[a->getRole()]--;
+}
+
+void TeamRoster::onRevive(const Agent* a) {
+    alive[a->getRole()]++;
+}
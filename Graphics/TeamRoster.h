@@ -0,0 +1,54 @@
+#pragma once
+#include "Definitions.h"
+#include <vector>
+
+// Forward declarations
+class Agent;
+class Commander;
+class Warrior;
+class Medic;
+class Provider;
+
+// ============================================================
+// TeamRoster
+// Indexes a team's agents by role once at spawn, so hot paths
+// can walk typed lists instead of dynamic_cast scans.
+// Alive counts per role are kept current by Agent on death /
+// revive (see Agent::setAlive).
+// ============================================================
+class TeamRoster {
+public:
+    // --- Registration (called once per agent at spawn) ---
+    void add(Agent* a);
+    void clear();
+
+    // --- Typed views ---
+    const std::vector<Agent*>& all() const { return members; }
+    const std::vector<Commander*>& commanders() const { return commanderList; }
+    const std::vector<Warrior*>& warriors() const { return warriorList; }
+    const std::vector<Medic*>& medics() const { return medicList; }
+    const std::vector<Provider*>& providers() const { return providerList; }
+
+    // First agent of a role (nullptr if the team has none)
+    Commander* commander() const { return commanderList.empty() ? nullptr : commanderList[0]; }
+    Medic* medic() const { return medicList.empty() ? nullptr : medicList[0]; }
+    Provider* provider() const { return providerList.empty() ? nullptr : providerList[0]; }
+
+    // --- Alive bookkeeping ---
+    int aliveCount(AgentRole r) const { return alive[r]; }
+    bool anyAlive(AgentRole r) const { return alive[r] > 0; }
+    int aliveTotal() const { return alive[ROLE_COMMANDER] + alive[ROLE_WARRIOR] + alive[ROLE_MEDIC] + alive[ROLE_PROVIDER]; }
+
+    // Notifications from Agent (alive flag flipped)
+    void onDeath(const Agent* a);
+    void onRevive(const Agent* a);
+
+private:
+    std::vector<Agent*> members;
+    std::vector<Commander*> commanderList;
+    std::vector<Warrior*> warriorList;
+    std::vector<Medic*> medicList;
+    std::vector<Provider*> providerList;
+
+    int alive[ROLE_COUNT] = { 0, 0, 0, 0 };
+};
@@ -0,0 +1,106 @@
+#include "TimingWheel.h"
+#include <climits>
+#include <algorithm>
+
+static const int SLOT_MASK = TimingWheel::SLOTS - 1;
+
+// ============================================================
+// Constructor / reset
+// ============================================================
+TimingWheel::TimingWheel() {}
+
+void TimingWheel::reset() {
+    for (int i = 0; i < SLOTS; ++i) {
+        level0[i].clear();
+        level1[i].clear();
+    }
+    overflow.clear();
+    current = 0;
+    count = 0;
+}
+
+// ============================================================
+// Scheduling
+// ============================================================
+void TimingWheel::place(const Wakeup& w) {
+    const int block0 = w.frame >> SLOT_BITS;
+    const int block1 = w.frame >> (2 * SLOT_BITS);
+
+    if (block0 == (current >> SLOT_BITS))
+        level0[w.frame & SLOT_MASK].push_back(w);
+    else if (block1 == (current >> (2 * SLOT_BITS)))
+        level1[block0 & SLOT_MASK].push_back(w);
+    else
+        overflow.push_back(w);
+}
+
+void TimingWheel::schedule(Agent* a, TimerKind kind, int frame) {
+    if (frame <= current) return;
+    place({ frame, a, kind });
+    count++;
+}
+
+// Called when the clock enters a new level-0 block
+void TimingWheel::cascade() {
+    // Entering a new level-1 block: pull its overflow entries in first
+    if ((current & ((1 << (2 * SLOT_BITS)) - 1)) == 0 && !overflow.empty()) {
+        std::vector<Wakeup> far;
+        far.swap(overflow);
+        for (const Wakeup& w : far) place(w);
+    }
+
+    std::vector<Wakeup>& slot = level1[(current >> SLOT_BITS) & SLOT_MASK];
+    for (const Wakeup& w : slot) place(w);
+    slot.clear();
+}
+
+// ============================================================
+// Ticking
+// ============================================================
+void TimingWheel::tick(std::vector<Wakeup>& fired) {
+    current++;
+    if ((current & SLOT_MASK) == 0) cascade();
+
+    std::vector<Wakeup>& slot = level0[current & SLOT_MASK];
+    if (slot.empty()) return;
+
+    fired.insert(fired.end(), slot.begin(), slot.end());
+    count -= slot.size();
+    slot.clear();
+}
+
+int TimingWheel::nextDue() const {
+    if (count == 0) return INT_MAX;
+
+    // Level 0: the rest of the current block, in frame order
+    for (int f = current + 1; (f & SLOT_MASK) != 0; ++f)
+        if (!level0[f & SLOT_MASK].empty()) return f;
+
+    // Level 1: first non-empty later block holds the earliest deadline
+    for (int b = (current >> SLOT_BITS) + 1; (b & SLOT_MASK) != 0; ++b) {
+        const std::vector<Wakeup>& slot = level1[b & SLOT_MASK];
+        if (slot.empty()) continue;
+
+        int best = INT_MAX;
+        for (const Wakeup& w : slot) best = std::min(best, w.frame);
+        return best;
+    }
+
+    int best = INT_MAX;
+    for (const Wakeup& w : overflow) best = std::min(best, w.frame);
+    return best;
+}
+
+void TimingWheel::skipTo(int frame) {
+    // Only block edges need work (cascades); nothing fires on the way
+    std::vector<Wakeup> none;
+    while (current < frame) {
+        int edge = (current | SLOT_MASK) + 1;
+        if (edge > frame) {
+            current = frame;
+            break;
+        }
+        current = edge - 1;
+        tick(none);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Forward declaration
+class Agent;
+
+// ============================================================
+// TimingWheel
+// Match-level clock and hierarchical timing wheel. All timers
+// are absolute frame deadlines on this clock; an agent that arms
+// a timer registers a wakeup here, and each tick hands back only
+// the wakeups that fell due.
+//
+//   level 0: 256 one-frame slots        (deadline in this 256-frame block)
+//   level 1: 256 slots of 256 frames    (deadline in this 65536-frame block)
+//   overflow: anything further out
+//
+// Outer levels cascade inward as the clock crosses block edges,
+// so scheduling and ticking are O(1) amortized. nextDue() lets
+// the headless fast-forward jump straight to the next wakeup.
+// ============================================================
+enum TimerKind : int {
+    TIMER_STEP = 0,   // next path step allowed (MOVE_DELAY)
+    TIMER_FIRE,       // weapon ready again
+    TIMER_REPLAN,     // path re-plan allowed again (Medic / Provider)
+    TIMER_THINK,      // commander strategic update
+    TIMER_RETARGET    // warrior chase target re-evaluated
+};
+
+struct Wakeup {
+    int frame;
+    Agent* agent;
+    TimerKind kind;
+};
+
+class TimingWheel {
+public:
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS; // slots per level
+
+    TimingWheel();
+
+    int now() const { return current; }
+
+    // Registers a wakeup; deadlines at or before now() are already due and ignored
+    void schedule(Agent* a, TimerKind kind, int frame);
+
+    // Advances the clock by one frame and appends the wakeups due on it
+    void tick(std::vector<Wakeup>& fired);
+
+    // Frame of the earliest pending wakeup (INT_MAX if none)
+    int nextDue() const;
+
+    // Moves the clock to 'frame'; nothing may be due on the way (frame < nextDue())
+    void skipTo(int frame);
+
+    void reset();
+    size_t pending() const { return count; }
+
+private:
+    void place(const Wakeup& w);
+    void cascade();
+
+    int current = 0;
+    size_t count = 0;
+
+    std::vector<Wakeup> level0[SLOTS];
+    std::vector<Wakeup> level1[SLOTS];
+    std::vector<Wakeup> overflow;
+};
@@ -4,10 +4,11 @@
 #include "Map.h"
 #include "MoveToTarget.h"
 #include "Idle.h"
-#include "Bullet.h"
-#include "Grenade.h"
+#include "ProjectileSystem.h"
 #include "Pathfinder.h"
-#include <list>
+#include "TeamRoster.h"
+#include "SpatialIndex.h"
+#include "EventScheduler.h"
 #include <algorithm>
 #include <cstdlib>
 #include <cstdio>
@@ -16,15 +17,12 @@
 extern std::vector<Agent*> gTeamOrange;
 extern std::vector<Agent*> gTeamBlue;
 extern Map* gWorldForStates;
+extern TeamRoster* gRosterOrange;
+extern TeamRoster* gRosterBlue;
+extern SpatialIndex* gSpatialIndex;
+extern ProjectileSystem* gProjectiles;
 
-static std::list<Grenade> gActiveGrenades;
-static std::list<Bullet> gActiveBullets;
-
-static inline bool isPassable(CellType ct) {
-    return (ct != ROCK && ct != WATER);
-}
-
-Warrior::Warrior(TeamColor t, int r, int c) : Agent(t, r, c) {}
+Warrior::Warrior(TeamColor t, int r, int c) : Agent(t, ROLE_WARRIOR, r, c) {}
 
 static std::mt19937& rng() {
     static std::mt19937 gen{ std::random_device{}() };
@@ -39,61 +37,13 @@ void Warrior::update(Map& world)
     Agent::update(world);
     if (!isAlive()) return;
 
-    if (fireCooldown > 0) fireCooldown--;
-    if (peekTimer > 0) peekTimer--;
 
     // 🧨 NEW: if out of ammo or low HP, seek safe area near base
     if (bullets == 0 || hp < 50.0) {
-        // stop current action
-        setMoving(false);
-
-        // determine base storage area by team
-        Vec2i baseStorage = (getTeam() == TEAM_ORANGE)
-            ? Vec2i{ 6, 9 }                // orange base
-        : Vec2i{ MSZ - 7, MSZ - 10 };  // blue base
-
-        // pick random nearby offset (within radius 4)
-        int radius = 2;
-        int bestR = baseStorage.r + (rand() % (radius * 2 + 1) - radius);
-        int bestC = baseStorage.c + (rand() % (radius * 2 + 1) - radius);
-
-        // clamp inside world
-        bestR = std::max(0, std::min(MSZ - 1, bestR));
-        bestC = std::max(0, std::min(MSZ - 1, bestC));
-
-        // make sure target is not blocked
-        CellType ct = world.at(bestR, bestC);
-        if (ct == ROCK || ct == WATER) {
-            // fallback: exact storage location
-            bestR = baseStorage.r;
-            bestC = baseStorage.c;
-        }
-
-        // pathfind there
-        std::vector<Vec2i> path;
-        Pathfinder::AStar(world, getPos(), { bestR, bestC }, path);
-        if (!path.empty()) {
-            setPath(path);
-            setTarget({ bestR, bestC });
-            setState(new MoveToTarget());
-            setMoving(true);
-           /* if (bullets == 0)
-                std::printf("🔫 %s Warrior out of ammo → heading to ammo area (%d,%d)\n",
-                    getTeam() == TEAM_ORANGE ? "Orange" : "Blue", bestR, bestC);
-            else
-                std::printf("💔 %s Warrior low HP (%.0f) → retreating to safe area (%d,%d)\n",
-                    getTeam() == TEAM_ORANGE ? "Orange" : "Blue", hp, bestR, bestC);*/
-        }
-        else {
-            setState(new Idle());
-           /* std::printf("⚠️ %s Warrior tried to retreat but no path found, staying put.\n",
-                getTeam() == TEAM_ORANGE ? "Orange" : "Blue");*/
-        }
-
+        retreat(world);
         return;
     }
-
-
+    retreating = false;
 
     if (mode == CombatMode::NONE) return;
 
@@ -103,6 +53,53 @@ void Warrior::update(Map& world)
         tickDefendLogic(world);
 }
 
+// ============================================================
+// Retreat
+// One rally cell near the base storage per retreat episode (from
+// the moment ammo or HP runs low until it is restored). The path
+// is planned once, by MoveToTarget::OnEnter with the team's danger
+// map; later ticks change nothing unless an order redirected the
+// warrior or the terrain changed under a failed plan.
+// ============================================================
+void Warrior::retreat(Map& world)
+{
+    if (retreating) {
+        if (getPos().r == retreatCell.r && getPos().c == retreatCell.c) return;
+        const bool redirected = getTarget().r != retreatCell.r || getTarget().c != retreatCell.c;
+        const bool stranded = getState() != MoveToTarget::instance()
+            && retreatVersion != world.terrainVersion();
+        if (!redirected && !stranded) return;
+    }
+    else {
+        // determine base storage area by team
+        Vec2i baseStorage = world.ammoStorage(getTeam());
+
+        // pick random nearby offset (within radius 2)
+        int radius = 2;
+        int bestR = baseStorage.r + (simRand() % (radius * 2 + 1) - radius);
+        int bestC = baseStorage.c + (simRand() % (radius * 2 + 1) - radius);
+
+        // clamp inside world; fall back to the exact storage location
+        // if the cell is blocked or cut off from here
+        retreatCell = world.clampCell(bestR, bestC);
+        if (world.blocksMovement(retreatCell.r, retreatCell.c) || !world.connected(getPos(), retreatCell))
+            retreatCell = baseStorage;
+        retreating = true;
+    }
+
+    // head there (OnEnter plans the path, or goes Idle if there is none)
+    retreatVersion = world.terrainVersion();
+    setMoving(false);
+    setTarget(retreatCell);
+    setState(MoveToTarget::instance());
+   /* if (bullets == 0)
+        std::printf("🔫 %s Warrior out of ammo → heading to ammo area (%d,%d)\n",
+            getTeam() == TEAM_ORANGE ? "Orange" : "Blue", retreatCell.r, retreatCell.c);
+    else
+        std::printf("💔 %s Warrior low HP (%.0f) → retreating to safe area (%d,%d)\n",
+            getTeam() == TEAM_ORANGE ? "Orange" : "Blue", hp, retreatCell.r, retreatCell.c);*/
+}
+
 // ============================================================
 // Receive orders
 // ============================================================
@@ -112,8 +109,8 @@ void Warrior::receiveOrder(const Order& o)
         mode = CombatMode::ATTACKING;
         rallyPoint = { o.targetRow, o.targetCol };
         setTarget(rallyPoint);
-        setState(new MoveToTarget());
-        retargetCounter = 0;
+        setState(MoveToTarget::instance());
+        chaseTarget = nullptr;
         return;
     }
 
@@ -121,8 +118,8 @@ void Warrior::receiveOrder(const Order& o)
         mode = CombatMode::DEFENDING;
         defendPoint = { o.targetRow, o.targetCol };
         setTarget(defendPoint);
-        setState(new MoveToTarget());
-        retargetCounter = 0;
+        setState(MoveToTarget::instance());
+        chaseTarget = nullptr;
         return;
     }
 
@@ -132,20 +129,10 @@ void Warrior::receiveOrder(const Order& o)
 // ============================================================
 // Find nearest visible enemy
 // ============================================================
-Agent* Warrior::findNearestVisibleEnemy(const std::vector<Agent*>& enemies) const
+Agent* Warrior::findNearestVisibleEnemy(TeamColor enemyTeam) const
 {
-    Agent* best = nullptr;
-    int bestD = 1e9;
-
-    for (auto* e : enemies) {
-        if (!e->isAlive()) continue;
-        if (!canSee(e->row(), e->col())) continue;
-
-        int d = std::abs(e->row() - row()) + std::abs(e->col() - col());
-        if (d < bestD) { bestD = d; best = e; }
-    }
-
-    return best;
+    return gSpatialIndex->nearest(getPos(), AgentFilter(enemyTeam),
+        [&](const Agent* e) { return canSee(e->row(), e->col()); });
 }
 
 // ============================================================
@@ -153,119 +140,108 @@ Agent* Warrior::findNearestVisibleEnemy(const std::vector<Agent*>& enemies) cons
 // ============================================================
 void Warrior::tickAttackLogic(Map& world)
 {
-    const std::vector<Agent*>& enemies =
-        (getTeam() == TEAM_ORANGE) ? gTeamBlue : gTeamOrange;
+    const TeamColor enemyTeam = (getTeam() == TEAM_ORANGE) ? TEAM_BLUE : TEAM_ORANGE;
+    const TeamRoster& enemyRoster =
+        (getTeam() == TEAM_ORANGE) ? *gRosterBlue : *gRosterOrange;
 
-    bool anyEnemyAlive = false;
-    bool anyEnemyWarriorAlive = false;
+    if (enemyRoster.aliveTotal() == 0) return;
 
-    for (auto* e : enemies) {
-        if (e->isAlive()) {
-            anyEnemyAlive = true;
-            if (dynamic_cast<Warrior*>(e))
-                anyEnemyWarriorAlive = true;
-        }
-    }
-
-    if (!anyEnemyAlive) return;
-
-    std::vector<Agent*> validTargets;
-    for (auto* e : enemies) {
-        if (!e->isAlive()) continue;
-        if (anyEnemyWarriorAlive && !dynamic_cast<Warrior*>(e)) continue;
-        validTargets.push_back(e);
-    }
-
-    if (!anyEnemyWarriorAlive) {
-        validTargets.clear();
-        for (auto* e : enemies)
-            if (e->isAlive()) validTargets.push_back(e);
-    }
+    // Enemy warriors take priority; support units only once they are down
+    const AgentFilter validTargets(enemyTeam,
+        enemyRoster.anyAlive(ROLE_WARRIOR) ? RoleBit(ROLE_WARRIOR) : ALL_ROLES);
 
     Agent* bestEnemy = nullptr;
-    int bestD = 1e9;
-
-    for (auto* e : validTargets) {
-        int d = std::abs(e->row() - row()) + std::abs(e->col() - col());
-        if (d < bestD && gWorldForStates &&
-            gWorldForStates->hasLineOfSight({ row(), col() }, { e->row(), e->col() })) {
-            bestD = d;
-            bestEnemy = e;
-        }
+    if (gWorldForStates) {
+        bestEnemy = gSpatialIndex->nearest(getPos(), validTargets, [&](const Agent* e) {
+            return gWorldForStates->hasLineOfSight({ row(), col() }, { e->row(), e->col() });
+            });
     }
 
     if (bestEnemy) {
         setMoving(false);
         int dist = std::abs(bestEnemy->row() - row()) + std::abs(bestEnemy->col() - col());
 
-        if (dist <= WEAPON_RANGE_CELLS &&
-            gWorldForStates->hasLineOfSight({ row(), col() }, { bestEnemy->row(), bestEnemy->col() })) {
+        if (dist <= WEAPON_RANGE_CELLS) {
 
-            int enemiesClose = 0;
-            for (auto* e : validTargets) {
-                if (!e->isAlive()) continue;
-                int d = std::abs(e->row() - row()) + std::abs(e->col() - col());
-                if (d <= 6) enemiesClose++;
-            }
+            int enemiesClose = gSpatialIndex->countWithin(getPos(), 6, validTargets);
 
-            if (enemiesClose >= 2 && grenades > 0 && fireCooldown == 0) {
+            if (enemiesClose >= 2 && grenades > 0 && weaponReady()) {
                 grenades--;
-                gActiveGrenades.emplace_back(col() + 0.5, row() + 0.5);
-                gActiveGrenades.back().setExploding(true);
+                gProjectiles->spawnGrenade(col() + 0.5, row() + 0.5);
 
                 // 💥 Apply area damage (grenades do stronger AOE damage)
                 const int GRENADE_DAMAGE = DAMAGE_PER_SHOT * 1.3;
                 const int BLAST_RADIUS = 3; // Manhattan distance
 
-                for (auto* e : enemies) {
-                    if (!e->isAlive()) continue;
-                    int dist = std::abs(e->row() - row()) + std::abs(e->col() - col());
-                    if (dist <= BLAST_RADIUS) {
+                gSpatialIndex->forEachWithin(getPos(), BLAST_RADIUS, AgentFilter(enemyTeam),
+                    [&](Agent* e, int /*dist*/) {
                         e->reduceHP(GRENADE_DAMAGE);
                         /*std::printf("💣 %s Warrior grenade hit enemy at (%d,%d) → enemy HP=%.0f\n",
                             getTeam() == TEAM_ORANGE ? "Orange" : "Blue",
                             e->row(), e->col(), e->getHP());*/
-                    }
-                }
+                    });
 
                 /*std::printf("💥 %s Warrior throws grenade! Remaining: %d\n",
                     getTeam() == TEAM_ORANGE ? "Orange" : "Blue", grenades);*/
 
-                fireCooldown = FIRE_COOLDOWN_FRAMES * 2;
+                armTimer(fireReadyFrame, TIMER_FIRE, FIRE_COOLDOWN_FRAMES * 2);
                 return;
             }
 
             // Regular fire
-            if (fireCooldown == 0 && bullets > 0) {
+            if (weaponReady() && bullets > 0) {
                 bullets = std::max(0, bullets - AMMO_COST_PER_SHOT);
                 bestEnemy->reduceHP(DAMAGE_PER_SHOT);
-                gActiveBullets.emplace_back(col() + 0.5, row() + 0.5,
+                gProjectiles->fireBullet(col() + 0.5, row() + 0.5,
                     bestEnemy->col() + 0.5, bestEnemy->row() + 0.5);
 
                 /*std::printf("%s Warrior fires → enemy HP=%.0f | bullets left=%d\n",
                     getTeam() == TEAM_ORANGE ? "Orange" : "Blue",
                     bestEnemy->getHP(), bullets);*/
 
-                fireCooldown = FIRE_COOLDOWN_FRAMES;
+                armTimer(fireReadyFrame, TIMER_FIRE, FIRE_COOLDOWN_FRAMES);
             }
             return;
         }
     }
 
-    Agent* closestAlive = nullptr;
-    int minDist = 1e9;
+    chaseEnemy(world, validTargets);
+}
 
-    for (auto* e : validTargets) {
-        if (!e->isAlive()) continue;
-        int d = std::abs(e->row() - row()) + std::abs(e->col() - col());
-        if (d < minDist) { minDist = d; closestAlive = e; }
-    }
+// ============================================================
+// Chase (throttled retargeting)
+// The nearest enemy and a path to it are re-evaluated on a fixed
+// per-warrior schedule: every RETARGET_EVERY frames, phase-shifted
+// by id so a squad that engages together re-plans on different
+// ticks. In between, the path is kept unless the target died or
+// drifted more than RETARGET_DRIFT cells from where it was aimed.
+// ============================================================
+int Warrior::retargetDelay() const
+{
+    return RETARGET_EVERY - (now() + id) % RETARGET_EVERY;
+}
+
+void Warrior::chaseEnemy(Map& world, const AgentFilter& validTargets)
+{
+    const bool due = now() >= retargetFrame;
+    const bool lost = !chaseTarget || !validTargets.accepts(chaseTarget);
 
-    if (closestAlive) {
-        std::vector<Vec2i> path;
-        Pathfinder::AStar(world, getPos(), closestAlive->getPos(), path);
-        if (!path.empty()) setPath(path);
+    if (!due && !lost) {
+        const Vec2i& at = chaseTarget->getPos();
+        int drift = std::abs(at.r - chaseGoal.r) + std::abs(at.c - chaseGoal.c);
+        if (drift <= RETARGET_DRIFT) return;
     }
+    else {
+        chaseTarget = gSpatialIndex->nearest(getPos(), validTargets);
+        if (!chaseTarget) return;
+    }
+
+    chaseGoal = chaseTarget->getPos();
+    armTimer(retargetFrame, TIMER_RETARGET, retargetDelay());
+
+    std::vector<Vec2i> path;
+    Pathfinder::AStar(world, getPos(), chaseGoal, path);
+    if (!path.empty()) setPath(path);
 }
 
 // ============================================================
@@ -273,10 +249,9 @@ void Warrior::tickAttackLogic(Map& world)
 // ============================================================
 void Warrior::tickDefendLogic(Map& world)
 {
-    const std::vector<Agent*>& enemies =
-        (getTeam() == TEAM_ORANGE) ? gTeamBlue : gTeamOrange;
+    const TeamColor enemyTeam = (getTeam() == TEAM_ORANGE) ? TEAM_BLUE : TEAM_ORANGE;
 
-    Agent* bestEnemy = findNearestVisibleEnemy(enemies);
+    Agent* bestEnemy = findNearestVisibleEnemy(enemyTeam);
     if (!bestEnemy) return;
 
     int d = std::abs(bestEnemy->row() - row()) + std::abs(bestEnemy->col() - col());
@@ -284,119 +259,78 @@ void Warrior::tickDefendLogic(Map& world)
     if (d <= WEAPON_RANGE_CELLS && gWorldForStates &&
         gWorldForStates->hasLineOfSight({ row(), col() }, { bestEnemy->row(), bestEnemy->col() })) {
 
-        if (fireCooldown == 0 && bullets > 0) {
+        if (weaponReady() && bullets > 0) {
             bullets = std::max(0, bullets - AMMO_COST_PER_SHOT);
             bestEnemy->reduceHP(DAMAGE_PER_SHOT);
-            gActiveBullets.emplace_back(col() + 0.5, row() + 0.5,
+            gProjectiles->fireBullet(col() + 0.5, row() + 0.5,
                 bestEnemy->col() + 0.5, bestEnemy->row() + 0.5);
 
            /* std::printf("%s Warrior (DEFEND) fires → enemy HP=%.0f | bullets left=%d\n",
                 getTeam() == TEAM_ORANGE ? "Orange" : "Blue",
                 bestEnemy->getHP(), bullets);*/
 
-            fireCooldown = FIRE_COOLDOWN_FRAMES;
+            armTimer(fireReadyFrame, TIMER_FIRE, FIRE_COOLDOWN_FRAMES);
         }
     }
 }
 
-// ============================================================
-// STATIC DRAW HELPERS
-// ============================================================
-void Warrior::updateBulletsAndDraw(Map& world)
-{
-    for (auto it = gActiveBullets.begin(); it != gActiveBullets.end(); )
-    {
-        it->move(world);
-        if (!it->isAlive()) it = gActiveBullets.erase(it);
-        else { it->draw(); ++it; }
-    }
-}
-
-void Warrior::updateGrenadesAndDraw(Map& world)
-{
-    for (auto it = gActiveGrenades.begin(); it != gActiveGrenades.end(); )
-    {
-        it->explode(world);
-        if (!it->isActive()) it = gActiveGrenades.erase(it);
-        else ++it;
-    }
-}
-
 // ============================================================
 // EXTRA FUNCTIONS
 // ============================================================
-void Warrior::tryAttackNearbyEnemies(const std::vector<Agent*>& enemies)
+void Warrior::tryAttackNearbyEnemies(TeamColor enemyTeam)
 {
-    if (fireCooldown > 0) return;
+    if (!weaponReady()) return;
+    if (!gWorldForStates) return;
 
-    Agent* best = nullptr;
-    int bestD = 1e9;
-
-    for (auto* e : enemies) {
-        if (!e->isAlive()) continue;
-        int d = std::abs(e->row() - row()) + std::abs(e->col() - col());
-        if (d <= WEAPON_RANGE_CELLS && gWorldForStates &&
-            gWorldForStates->hasLineOfSight({ row(),col() }, { e->row(),e->col() })) {
-            if (d < bestD) { bestD = d; best = e; }
-        }
-    }
+    Agent* best = gSpatialIndex->nearest(getPos(), AgentFilter(enemyTeam), [&](const Agent* e) {
+        return gWorldForStates->hasLineOfSight({ row(),col() }, { e->row(),e->col() });
+        }, WEAPON_RANGE_CELLS);
 
     if (best && best->isAlive() && bullets > 0) {
         bullets = std::max(0, bullets - AMMO_COST_PER_SHOT);
         best->reduceHP(DAMAGE_PER_SHOT);
-        gActiveBullets.emplace_back(col() + 0.5, row() + 0.5,
+        gProjectiles->fireBullet(col() + 0.5, row() + 0.5,
             best->col() + 0.5, best->row() + 0.5);
 
     /*    std::printf("%s Warrior (tick) fires → enemy HP=%.0f | bullets left=%d\n",
             getTeam() == TEAM_ORANGE ? "Orange" : "Blue",
             best->getHP(), bullets);*/
 
-        fireCooldown = FIRE_COOLDOWN_FRAMES;
+        armTimer(fireReadyFrame, TIMER_FIRE, FIRE_COOLDOWN_FRAMES);
     }
 }
 
+// ============================================================
+// Event scheduling
+// ============================================================
+void Warrior::hashState(StateHash& h) const
+{
+    Agent::hashState(h);
+    h.add(int64_t(mode));
+    h.add(rallyPoint);
+    h.add(defendPoint);
+    h.add(coverPos);
+    h.add(int64_t(peek));
+    h.add(chaseTarget);
+    h.add(chaseGoal);
+    h.add(int64_t(retargetFrame));
+    h.add(int64_t(retreating));
+    h.add(retreatCell);
+    h.add(int64_t(grenades));
+    h.add(int64_t(fireReadyFrame));
+}
+
 // ============================================================
 // Find best cover cell nearby
 // ============================================================
 bool Warrior::findBestCoverNear(int r0, int c0, const Map& world, int radius,
     int& outR, int& outC) const
 {
-    int bestR = -1, bestC = -1, bestScore = -1000000000;
-
-    for (int dr = -radius; dr <= radius; ++dr) {
-        for (int dc = -radius; dc <= radius; ++dc) {
-            int rr = r0 + dr, cc = c0 + dc;
-            if (!world.inBounds(rr, cc)) continue;
+    Vec2i best;
+    if (!world.kernels().findCover(world.terrainBits(), { r0, c0 }, radius, best))
+        return false;
 
-            CellType ct = world.at(rr, cc);
-            if (ct == ROCK || ct == WATER) continue;
-
-            static const int adjR[4] = { -1, 1, 0, 0 };
-            static const int adjC[4] = { 0, 0, -1, 1 };
-            bool hasCover = false;
-
-            for (int k = 0; k < 4; ++k) {
-                int nr = rr + adjR[k], nc = cc + adjC[k];
-                if (!world.inBounds(nr, nc)) continue;
-                CellType nt = world.at(nr, nc);
-                if (nt == ROCK || nt == TREE) { hasCover = true; break; }
-            }
-
-            if (hasCover) {
-                int score = -(std::abs(rr - r0) + std::abs(cc - c0));
-                if (score > bestScore) {
-                    bestScore = score;
-                    bestR = rr;
-                    bestC = cc;
-                }
-            }
-        }
-    }
-
-    if (bestR >= 0) {
-        outR = bestR;
-        outC = bestC;
-        return true;
-    }
-    return false;
+    outR = best.r;
+    outC = best.c;
+    return true;
 }
@@ -4,6 +4,7 @@
 
 // Forward declarations
 class Map;
+struct AgentFilter;
 
 // ============================================================
 // Warrior class
@@ -18,16 +19,15 @@ public:
     // --- Core behavior ---
     void update(Map& world) override;
     void receiveOrder(const Order& o) override;
-    void tryAttackNearbyEnemies(const std::vector<Agent*>& enemies);
+    void tryAttackNearbyEnemies(TeamColor enemyTeam);
 
     // --- Grenade system ---
     int getGrenades() const { return grenades; }
     void useGrenade() { if (grenades > 0) grenades--; }
     void refillGrenades() { grenades = 3; }
 
-    // --- Static render helpers ---
-    static void updateBulletsAndDraw(Map& world);
-    static void updateGrenadesAndDraw(Map& world);
+    // --- Event scheduling ---
+    void hashState(StateHash& h) const override;
 
 private:
     // --- Combat states ---
@@ -37,7 +37,10 @@ private:
     // --- Internal behavior ---
     void tickAttackLogic(Map& world);
     void tickDefendLogic(Map& world);
-    Agent* findNearestVisibleEnemy(const std::vector<Agent*>& enemies) const;
+    void retreat(Map& world);
+    Agent* findNearestVisibleEnemy(TeamColor enemyTeam) const;
+    void chaseEnemy(Map& world, const AgentFilter& validTargets);
+    int retargetDelay() const;
 
     // --- Cover and vision helpers ---
     bool findBestCoverNear(int r0, int c0, const Map& world, int radius, int& outR, int& outC) const;
@@ -49,11 +52,20 @@ private:
     Vec2i coverPos = { -1, -1 };
 
     PeekState peek = PeekState::HIDING;
-    int peekTimer = 0;
-    int retargetCounter = 0;
+
+    // --- Chase (attack mode, no enemy in sight) ---
+    Agent* chaseTarget = nullptr;   // enemy the current path leads to
+    Vec2i chaseGoal = { -1, -1 };   // its cell when the path was planned
+    int retargetFrame = 0;          // match frame of the next re-evaluation
+
+    // --- Retreat (out of ammo or low HP) ---
+    bool retreating = false;
+    Vec2i retreatCell = { -1, -1 };  // rally cell of this episode
+    uint32_t retreatVersion = 0;     // terrain version it was last planned on
 
     // --- Constants ---
-    static const int RETARGET_EVERY = 45;
+    static const int RETARGET_EVERY = 45;  // frames between chase re-evaluations
+    static const int RETARGET_DRIFT = 2;   // target cells moved before an early re-plan
     static const int WEAPON_RANGE_CELLS = 8;
     static const int FIRE_COOLDOWN_FRAMES = 75;
     static const int SEEK_COVER_RADIUS = 6;
@@ -63,8 +75,9 @@ private:
     static const int HIT_CHANCE_PERCENT = 40;
     static const int AMMO_COST_PER_SHOT = 2;
 
-    int grenades = 3;      // initial grenade count
-    int fireCooldown = 0;  // delay between shots
-    int reloadTimer = 0; // counts frames when waiting near ammo
+    int grenades = 3;       // initial grenade count
+    int fireReadyFrame = 0; // match frame from which the weapon can fire again
+
+    bool weaponReady() const { return now() >= fireReadyFrame; }
 
 };
@@ -1,26 +1,55 @@
 // ============================================================
 // main.cpp
 // Entry point for the AI Battle Simulation project
+//
+// Usage:
+//   battle                     windowed run
+//   battle --speed N           run N simulation ticks per redraw
+//   battle --headless [F]      no window; simulate until the battle
+//                              ends (or F frames) and print a summary
+//   battle --seed S            fixed random seed (reproducible runs)
+//   battle --no-skip           headless: step every frame instead of
+//                              jumping over idle stretches
+//   battle --size N | RxC      map dimensions (default 40x40)
+//   battle --bench             time the grid kernels on a generated
+//                              map of --size and exit
+//   battle --first-moves       precompute a first-move table (maps up
+//                              to 128x128) for danger-free path queries;
+//                              cached as firstmoves-<terrain>.cpd
 // ============================================================
 
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include "glut.h"
 #include "Definitions.h"
 #include "Game.h"
+#include "Bench.h"
+#include "Pathfinder.h"
+#include "Agent.h"
 
 // ------------------------------------------------------------
 // Global game pointer
 // ------------------------------------------------------------
 static Game* g = nullptr;
+static int gStepsPerRedraw = SIM_STEPS_PER_REDRAW;
+static bool gHasSeed = false;
+static unsigned gSeed = 0;
+static int gMapRows = DEFAULT_MAP_SIZE;
+static int gMapCols = DEFAULT_MAP_SIZE;
+static bool gFirstMoves = false;
 
 // ------------------------------------------------------------
 // OpenGL initialization
 // ------------------------------------------------------------
-static void initGL() {
+static void initGL(const Map& world) {
     glClearColor(0.3, 0.3, 0.3, 0.0);  // gray background
-    glOrtho(0, MSZ, 0, MSZ, -1, 1);    // top-down orthographic view
+    glOrtho(0, world.cols(), 0, world.rows(), -1, 1);    // top-down orthographic view
 }
 
 // ------------------------------------------------------------
@@ -34,16 +63,138 @@ static void display() {
 
 // ------------------------------------------------------------
 // Idle callback (main game loop trigger)
+// Simulation and display rates are independent: each redraw
+// runs gStepsPerRedraw simulation ticks.
 // ------------------------------------------------------------
 static void idle() {
-    if (g) g->update();
+    if (g)
+        for (int i = 0; i < gStepsPerRedraw; ++i)
+            g->update();
     glutPostRedisplay();
 }
 
+// ------------------------------------------------------------
+// Headless run (no window, no rendering)
+// ------------------------------------------------------------
+// First-move table for the generated terrain: loaded if an earlier
+// run saved one for the same terrain, otherwise built on every
+// hardware thread and saved.
+static void precomputeFirstMoves(const Map& world) {
+    FirstMoveTable& table = Pathfinder::firstMoves();
+    char path[64];
+    std::snprintf(path, sizeof(path), "firstmoves-%016llx.cpd",
+        (unsigned long long)FirstMoveTable::terrainHash(world));
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool loaded = table.load(path, world);
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    if (!loaded && !table.build(world, threads)) {
+        std::printf("first moves: map larger than %d cells, searching instead\n",
+            FirstMoveTable::MAX_CELLS);
+        return;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    if (loaded)
+        std::printf("first moves: loaded %s in %.1f ms", path, ms);
+    else
+        std::printf("first moves: built in %.1f ms on %d threads, %s %s", ms, threads,
+            table.save(path) ? "saved to" : "could not save", path);
+    std::printf(" (%zu runs, %.1f KB)\n", table.runCount(), table.bytes() / 1024.0);
+}
+
+static void initGame(Game& game) {
+    if (gHasSeed) game.init(gSeed);
+    else          game.init();
+    if (gFirstMoves) precomputeFirstMoves(game.getMap());
+}
+
+static int runHeadless(int maxFrames, bool skipIdle) {
+    Game game(gMapRows, gMapCols);
+    initGame(game);
+
+    clock_t t0 = clock();
+    while (!game.gameOver && game.getFrame() < maxFrames) {
+        if (skipIdle) game.advance(maxFrames - game.getFrame() - 1);
+        else          game.update();
+    }
+    double secs = double(clock() - t0) / CLOCKS_PER_SEC;
+
+    std::printf("frames: %d  (%.2f s, %.0f ticks/s)\n",
+        game.getFrame(), secs, secs > 0 ? game.getFrame() / secs : 0.0);
+    std::printf("map: %dx%d  (kernels: %s)\n",
+        game.getMap().rows(), game.getMap().cols(), game.getMap().kernels().name);
+    if (skipIdle)
+        std::printf("simulated: %lld  skipped: %lld\n",
+            game.getScheduler().simulatedFrames(), game.getScheduler().skippedFrames());
+    const PathCacheStats& pc = Pathfinder::cacheStats();
+    std::printf("path cache: %lld hits (%lld subpath), %lld misses\n",
+        pc.hits + pc.subpathHits, pc.subpathHits, pc.misses);
+    if (Pathfinder::fieldWalks() > 0)
+        std::printf("squad field walks: %lld\n", Pathfinder::fieldWalks());
+    if (gFirstMoves)
+        std::printf("first-move walks: %lld\n", Pathfinder::firstMoveWalks());
+    const size_t ticks = game.getUpdateCount();
+    std::printf("allocations: %.1f per tick (max %zu, %zu ticks)\n",
+        ticks ? double(game.getAllocationsTotal()) / ticks : 0.0, game.getAllocationsMax(), ticks);
+    std::printf("agent visits: %.1f per tick (%zu left out on quiet frames)\n",
+        ticks ? double(game.getAgentVisits()) / ticks : 0.0, game.getAgentsSkipped());
+    const size_t transitions = Agent::transitionCount();
+    std::printf("transitions: %zu  (%zu allocations in state switches, %.1f each in OnEnter / OnExit)\n",
+        transitions, Agent::transitionAllocations(),
+        transitions ? double(Agent::stateHookAllocations()) / transitions : 0.0);
+    std::printf("state: %016llx\n", (unsigned long long)game.stateHash());
+    std::printf("result: %s\n", game.gameOver ? game.winningTeam.c_str() : "no winner (frame cap)");
+
+    // A state switch must not allocate (states are shared flyweights)
+    if (Agent::transitionAllocations() != 0) {
+        std::printf("error: state switches allocated\n");
+        return 1;
+    }
+    return 0;
+}
+
 // ------------------------------------------------------------
 // Main entry point
 // ------------------------------------------------------------
 int main(int argc, char* argv[]) {
+    bool headless = false;
+    bool bench = false;
+    bool skipIdle = true;
+    int maxFrames = HEADLESS_MAX_FRAMES;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') maxFrames = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            gStepsPerRedraw = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            gHasSeed = true;
+            gSeed = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--no-skip") == 0)
+            skipIdle = false;
+        else if (std::strcmp(argv[i], "--bench") == 0)
+            bench = true;
+        else if (std::strcmp(argv[i], "--first-moves") == 0)
+            gFirstMoves = true;
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            // "N" for a square map, "RxC" otherwise
+            char* end = nullptr;
+            gMapRows = (int)std::strtol(argv[++i], &end, 10);
+            gMapCols = (end && (*end == 'x' || *end == 'X')) ? std::atoi(end + 1) : gMapRows;
+            gMapRows = std::max(MIN_MAP_SIZE, gMapRows);
+            gMapCols = std::max(MIN_MAP_SIZE, gMapCols);
+        }
+    }
+
+    if (bench)
+        return runBench(gMapRows, gMapCols, gHasSeed ? gSeed : 1u);
+    if (headless)
+        return runHeadless(maxFrames, skipIdle);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE);
     glutInitWindowSize(WIN_W, WIN_H);
@@ -55,9 +206,9 @@ int main(int argc, char* argv[]) {
     glutIdleFunc(idle);
 
     // Initialize OpenGL and game
-    initGL();
-    g = new Game();
-    g->init();
+    g = new Game(gMapRows, gMapCols);
+    initGame(*g);
+    initGL(g->getMap());
 
     // Enter main event loop
     glutMainLoop();